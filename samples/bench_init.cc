@@ -0,0 +1,63 @@
+#include "bench_util.h"
+#include "runtime/net.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// times Net::Init end to end, the graph load, the graph rewrite, layer creation and weight
+// packing and the memory plan. "chain 2000" generates the chain of 2000 nn.Linear layers of
+// 8 features the init numbers were measured on, the per layer cost dominates there
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("usage: ./bin/bench_init "
+               "{param} "
+               "{bin} "
+               "[iterations=20] \n"
+               "       ./bin/bench_init chain "
+               "{layers} "
+               "[iterations=20] \n");
+        return -1;
+    }
+    const int iterations = argc > 3 ? std::max(1, atoi(argv[3])) : 20;
+
+    std::string param = argv[1];
+    std::string bin   = argv[2];
+    if (param == "chain") {
+        const int layers       = std::max(1, atoi(argv[2]));
+        const std::string path = "linear_chain_" + std::to_string(layers) + ".pnnx";
+        if (!bench::WriteLinearChain(path, layers, 8)) {
+            printf("write %s failed\n", path.c_str());
+            return -1;
+        }
+        param = path + ".param";
+        bin   = path + ".bin";
+    }
+
+    auto option         = std::make_shared<nn::NetOption>();
+    option->num_threads = 1;
+
+    size_t workspace = 0;
+    std::vector<double> costs;
+    auto init = [&]() -> std::shared_ptr<nn::Net> {
+        auto net = std::make_shared<nn::Net>("bench_init", option);
+        if (net->Init(param, bin) != MStatus::M_OK) {
+            return nullptr;
+        }
+        workspace = net->GetWorkspaceSize();
+        return net;
+    };
+    if (!bench::TimeBuild(iterations, init, costs)) {
+        printf("init %s failed\n", param.c_str());
+        return -1;
+    }
+    const bench::Stats stats = bench::Summarize(costs);
+
+    printf("init %s, workspace %zu bytes, iterations %i\n",
+           param.c_str(),
+           workspace,
+           iterations);
+    printf("min %.3f ms, median %.3f ms, avg %.3f ms\n", stats.min, stats.median, stats.mean);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "bench_util.h"
+#include "runtime/net.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+// times nn.Linear through the runtime on samples/models/linear_512_1000.pnnx.*
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("usage: ./bin/bench_linear "
+               "{param} "
+               "{bin} "
+               "[iterations=1000] "
+               "[threads=1] \n");
+        return -1;
+    }
+    const int iterations = argc > 3 ? std::max(1, atoi(argv[3])) : 1000;
+    const int threads    = argc > 4 ? std::max(1, atoi(argv[4])) : 1;
+
+    auto option         = std::make_shared<nn::NetOption>();
+    option->num_threads = threads;
+    auto net            = std::make_shared<nn::Net>("linear", option);
+    if (net->Init(argv[1], argv[2]) != MStatus::M_OK || net->GetInputNum() != 1 ||
+        net->GetOutputNum() != 1) {
+        printf("load %s failed\n", argv[1]);
+        return -1;
+    }
+
+    const std::vector<int>& in_shape  = net->GetInputShape(0);
+    const std::vector<int>& out_shape = net->GetOutputShape(0);
+    std::vector<uint32_t> shape(in_shape.begin(), in_shape.end());
+    auto input = std::make_shared<base::Tensor>(
+        shape, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    size_t in_count = 1;
+    for (int dim : in_shape) {
+        in_count *= dim;
+    }
+    for (size_t i = 0; i < in_count; ++i) {
+        input->GetData<float>()[i] = static_cast<float>(i % 17) / 17.f - 0.5f;
+    }
+
+    // y[M, N] = x[M, K] * W^T costs 2 * M * K * N flops
+    const double flops = 2.0 * static_cast<double>(in_count) * out_shape.back();
+
+    std::vector<std::shared_ptr<base::Tensor>> output;
+    for (int i = 0; i < 10; ++i) {
+        net->Forward({input}, output);
+    }
+
+    std::vector<double> costs;
+    auto forward = [&]() { return net->Forward({input}, output) == MStatus::M_OK; };
+    if (!bench::TimeRuns(iterations, forward, costs)) {
+        printf("forward %s failed\n", argv[1]);
+        return -1;
+    }
+    const bench::Stats stats = bench::Summarize(costs);
+
+    printf("linear threads %i, iterations %i\n", threads, iterations);
+    printf("min %.2f us, median %.2f us, avg %.2f us, %.2f GFLOP/s\n",
+           stats.min,
+           stats.median,
+           stats.mean,
+           flops / stats.mean * 1e-3);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "bench_util.h"
+#include "runtime/pnnx/ir.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+// times pnnx::Graph::load on a model such as samples/models/yolov5s_batch8.pnnx.*, the
+// parse of the param file and the attribute load of the bin are what model init pays
+// before any layer is created
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("usage: ./bin/bench_load "
+               "{param} "
+               "{bin} "
+               "[iterations=20] "
+               "[mmap=1] \n");
+        return -1;
+    }
+    const int iterations = argc > 3 ? std::max(1, atoi(argv[3])) : 20;
+    const bool use_mmap  = argc > 4 ? atoi(argv[4]) != 0 : true;
+
+    size_t op_count      = 0;
+    size_t operand_count = 0;
+    std::vector<double> costs;
+    auto load = [&]() -> std::unique_ptr<pnnx::Graph> {
+        std::unique_ptr<pnnx::Graph> graph(new pnnx::Graph());
+        if (graph->load(argv[1], argv[2], use_mmap) != 0) {
+            return nullptr;
+        }
+        op_count      = graph->ops.size();
+        operand_count = graph->operands.size();
+        return graph;
+    };
+    if (!bench::TimeBuild(iterations, load, costs)) {
+        printf("load %s failed\n", argv[1]);
+        return -1;
+    }
+    const bench::Stats stats = bench::Summarize(costs);
+
+    printf("load %s, ops %zu, operands %zu, mmap %i, iterations %i\n",
+           argv[1],
+           op_count,
+           operand_count,
+           use_mmap ? 1 : 0,
+           iterations);
+    printf("min %.3f ms, median %.3f ms, avg %.3f ms\n", stats.min, stats.median, stats.mean);
+    return 0;
+}
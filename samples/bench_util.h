@@ -0,0 +1,127 @@
+#ifndef SIMPLE_NN_SAMPLES_BENCH_UTIL_H_
+#define SIMPLE_NN_SAMPLES_BENCH_UTIL_H_
+
+#include "runtime/pnnx/store_zip.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// timing, statistics and the generated models shared by the benchmark samples
+namespace bench {
+using Clock = std::chrono::steady_clock;
+
+/// @brief distribution of repeated timings, in the unit they were taken in
+struct Stats {
+    double min{0};
+    double median{0};
+    double p99{0};
+    double mean{0};
+};
+
+inline Stats Summarize(std::vector<double> costs) {
+    Stats stats;
+    if (costs.empty()) {
+        return stats;
+    }
+    std::sort(costs.begin(), costs.end());
+    double total = 0.0;
+    for (double cost : costs) {
+        total += cost;
+    }
+    const size_t p99 = static_cast<size_t>(std::ceil(costs.size() * 0.99)) - 1;
+
+    stats.min    = costs.front();
+    stats.median = costs[costs.size() / 2];
+    stats.p99    = costs[std::min(p99, costs.size() - 1)];
+    stats.mean   = total / costs.size();
+    return stats;
+}
+
+/// @brief milliseconds of every one of iterations calls of build, which returns the object it
+/// made or null on failure. the object is torn down after the clock stopped
+template <typename Build>
+bool TimeBuild(int iterations, const Build& build, std::vector<double>& costs) {
+    costs.assign(iterations, 0.0);
+    for (int i = 0; i < iterations; ++i) {
+        auto start  = Clock::now();
+        auto object = build();
+        costs[i]    = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (!object) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief microseconds of every one of iterations calls of run, which returns false on failure
+template <typename Run>
+bool TimeRuns(int iterations, const Run& run, std::vector<double>& costs) {
+    costs.assign(iterations, 0.0);
+    for (int i = 0; i < iterations; ++i) {
+        auto start    = Clock::now();
+        const bool ok = run();
+        costs[i]      = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief write a pnnx model of layers nn.Linear [1, features] -> [1, features] in a chain,
+/// the large graph the init and load benchmarks are measured on
+/// @param[in] path prefix of the written path.param and path.bin
+inline bool WriteLinearChain(const std::string& path, int layers, int features) {
+    pnnx::StoreZipWriter writer;
+    if (writer.open(path + ".bin") != 0) {
+        return false;
+    }
+    std::vector<float> weight(static_cast<size_t>(features) * features);
+    std::vector<float> bias(features);
+    for (size_t i = 0; i < weight.size(); ++i) {
+        weight[i] = static_cast<float>(i % 7) / 7.f - 0.5f;
+    }
+    for (int i = 0; i < features; ++i) {
+        bias[i] = static_cast<float>(i % 5) / 5.f;
+    }
+
+    FILE* fp = fopen((path + ".param").c_str(), "wb");
+    if (!fp) {
+        writer.close();
+        return false;
+    }
+    fprintf(fp, "7767517\n%i %i\n", layers + 2, layers + 1);
+    fprintf(fp, "pnnx.Input in0 0 1 0 #0=(1,%i)f32\n", features);
+    for (int i = 0; i < layers; ++i) {
+        const std::string name = "fc" + std::to_string(i);
+        fprintf(fp,
+                "nn.Linear %s 1 1 %i %i bias=True in_features=%i out_features=%i "
+                "@weight=(%i,%i)f32 @bias=(%i)f32 #%i=(1,%i)f32\n",
+                name.c_str(),
+                i,
+                i + 1,
+                features,
+                features,
+                features,
+                features,
+                features,
+                i + 1,
+                features);
+        writer.write_file(name + ".weight",
+                          reinterpret_cast<const char*>(weight.data()),
+                          weight.size() * sizeof(float));
+        writer.write_file(name + ".bias",
+                          reinterpret_cast<const char*>(bias.data()),
+                          bias.size() * sizeof(float));
+    }
+    fprintf(fp, "pnnx.Output out0 1 0 %i\n", layers);
+    fclose(fp);
+    return writer.close() == 0;
+}
+} // namespace bench
+
+#endif // SIMPLE_NN_SAMPLES_BENCH_UTIL_H_
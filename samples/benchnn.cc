@@ -0,0 +1,352 @@
+#include "bench_util.h"
+#include "runtime/net.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// regression benchmark over the bundled models in samples/models, every model runs warmup
+// and timed forwards at each thread count in a forked process of its own and reports latency
+// percentiles, throughput and the peak resident memory of that process, as a table and
+// optionally as json. models using ops the runtime has no layer for are skipped
+namespace {
+const char* const BUNDLED_MODELS[] = {
+    "linear_512_1000.pnnx",
+    "squeezenet_v1.1",
+    "yolov5s_batch8.pnnx",
+};
+
+enum RunStatus {
+    RUN_OK,
+    // the model uses an op the runtime has no layer for
+    RUN_SKIPPED,
+    RUN_FAILED,
+};
+
+// what a run measures, plain data so the forked process can hand it back through a pipe
+struct Measure {
+    int status{RUN_FAILED};
+    char error[64]{};
+    double init_ms{0};
+    size_t workspace{0};
+    int batch{1};
+    double min_us{0};
+    double median_us{0};
+    double p99_us{0};
+    double mean_us{0};
+    // samples along the batch dimension of the first input per second
+    double throughput{0};
+    // peak resident set of the process that ran the model
+    long peak_rss_kb{0};
+};
+
+struct BenchResult {
+    std::string model;
+    int threads{0};
+    Measure measure;
+};
+
+long PeakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    // kilobytes on linux
+    return usage.ru_maxrss;
+}
+
+std::vector<int> ParseThreads(const std::string& list) {
+    std::vector<int> threads;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int count = atoi(item.c_str());
+        if (count > 0) {
+            threads.push_back(count);
+        }
+    }
+    return threads;
+}
+
+bool EndsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string EscapeJson(const std::string& str) {
+    std::string out;
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+    }
+    return out;
+}
+
+void Fail(Measure& result, int status, const char* error) {
+    result.status = status;
+    snprintf(result.error, sizeof(result.error), "%s", error);
+    result.peak_rss_kb = PeakRssKb();
+}
+
+Measure RunModel(const std::string& model,
+                 const std::string& param,
+                 const std::string& bin,
+                 int threads,
+                 int warmup,
+                 int iterations) {
+    Measure result;
+
+    auto option         = std::make_shared<nn::NetOption>();
+    option->num_threads = threads;
+    nn::Net net(model, option);
+    auto start  = bench::Clock::now();
+    MStatus ret = net.Init(param, bin);
+    // only an op without a layer skips the model, any other M_NOT_SUPPORT is a regression
+    if (ret == MStatus::M_NOT_SUPPORT && !net.GetUnsupportedOp().empty()) {
+        const std::string error = "no layer for " + net.GetUnsupportedOp();
+        Fail(result, RUN_SKIPPED, error.c_str());
+        return result;
+    }
+    if (ret != MStatus::M_OK || !net.GetInputNum()) {
+        Fail(result, RUN_FAILED, "init failed");
+        return result;
+    }
+    result.init_ms =
+        std::chrono::duration<double, std::milli>(bench::Clock::now() - start).count();
+    result.workspace = net.GetWorkspaceSize();
+
+    // deterministic inputs of the static shapes
+    std::vector<nn::Net::TensorPtr> inputs;
+    for (size_t i = 0; i < net.GetInputNum(); ++i) {
+        const std::vector<int>& in_shape = net.GetInputShape(i);
+        std::vector<uint32_t> shape(in_shape.begin(), in_shape.end());
+        auto input = std::make_shared<base::Tensor>(
+            shape, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+        size_t count = 1;
+        for (int dim : in_shape) {
+            count *= dim;
+        }
+        for (size_t j = 0; j < count; ++j) {
+            input->GetData<float>()[j] = static_cast<float>(j % 17) / 17.f - 0.5f;
+        }
+        inputs.emplace_back(std::move(input));
+    }
+    const std::vector<int>& first_shape = net.GetInputShape(0);
+    result.batch = first_shape.empty() ? 1 : std::max(1, first_shape[0]);
+
+    std::vector<nn::Net::TensorPtr> outputs;
+    for (int i = 0; i < warmup; ++i) {
+        if (net.Forward(inputs, outputs) != MStatus::M_OK) {
+            Fail(result, RUN_FAILED, "forward failed");
+            return result;
+        }
+    }
+
+    std::vector<double> costs;
+    auto forward = [&]() { return net.Forward(inputs, outputs) == MStatus::M_OK; };
+    if (!bench::TimeRuns(iterations, forward, costs)) {
+        Fail(result, RUN_FAILED, "forward failed");
+        return result;
+    }
+    const bench::Stats stats = bench::Summarize(costs);
+
+    result.min_us      = stats.min;
+    result.median_us   = stats.median;
+    result.p99_us      = stats.p99;
+    result.mean_us     = stats.mean;
+    result.throughput  = result.batch * 1e6 / result.mean_us;
+    result.peak_rss_kb = PeakRssKb();
+    result.status      = RUN_OK;
+    return result;
+}
+
+// RunModel in a forked process so the peak memory of one run is not inherited by the next,
+// whatever the model prints goes to stderr
+Measure RunIsolated(const std::string& model,
+                    const std::string& param,
+                    const std::string& bin,
+                    int threads,
+                    int warmup,
+                    int iterations) {
+    Measure result;
+    int fds[2];
+    if (pipe(fds) != 0) {
+        Fail(result, RUN_FAILED, "pipe failed");
+        return result;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        result = RunModel(model, param, bin, threads, warmup, iterations);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        Fail(result, RUN_FAILED, "fork failed");
+        return result;
+    }
+
+    size_t received = 0;
+    char* data      = reinterpret_cast<char*>(&result);
+    while (received < sizeof(result)) {
+        ssize_t count = read(fds[0], data + received, sizeof(result) - received);
+        if (count <= 0) {
+            break;
+        }
+        received += count;
+    }
+    close(fds[0]);
+    int wstatus = 0;
+    waitpid(pid, &wstatus, 0);
+    if (received != sizeof(result)) {
+        result = Measure();
+        if (WIFSIGNALED(wstatus)) {
+            snprintf(result.error, sizeof(result.error), "killed by signal %i", WTERMSIG(wstatus));
+        } else {
+            snprintf(result.error, sizeof(result.error), "no result");
+        }
+    }
+    return result;
+}
+
+const char* StatusName(int status) {
+    return status == RUN_OK ? "ok" : status == RUN_SKIPPED ? "skipped" : "failed";
+}
+
+
+std::string ToJson(const std::vector<BenchResult>& results, int warmup, int iterations) {
+    std::stringstream ss;
+    ss << "{\n  \"warmup\": " << warmup << ",\n  \"iterations\": " << iterations
+       << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Measure& r = results[i].measure;
+        ss << (i ? ",\n" : "\n") << "    {\"model\": \"" << EscapeJson(results[i].model)
+           << "\", \"threads\": " << results[i].threads << ", \"status\": \""
+           << StatusName(r.status) << "\"";
+        if (r.status != RUN_OK) {
+            ss << ", \"error\": \"" << EscapeJson(r.error) << "\"";
+        } else {
+            ss << ", \"init_ms\": " << r.init_ms << ", \"workspace_bytes\": " << r.workspace
+               << ", \"batch\": " << r.batch << ", \"min_us\": " << r.min_us
+               << ", \"median_us\": " << r.median_us << ", \"p99_us\": " << r.p99_us
+               << ", \"mean_us\": " << r.mean_us << ", \"throughput_per_s\": " << r.throughput;
+        }
+        ss << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+    }
+    ss << "\n  ]\n}\n";
+    return ss.str();
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
+        printf("usage: ./bin/benchnn "
+               "[models=samples/models, a directory or a single .param] "
+               "[warmup=10] "
+               "[iterations=100] "
+               "[threads=1,2,4] "
+               "[json={path}, - for stdout] \n");
+        return 0;
+    }
+    const std::string models    = argc > 1 ? argv[1] : "samples/models";
+    const int warmup            = argc > 2 ? std::max(0, atoi(argv[2])) : 10;
+    const int iterations        = argc > 3 ? std::max(1, atoi(argv[3])) : 100;
+    const std::vector<int> list = ParseThreads(argc > 4 ? argv[4] : "1,2,4");
+    const std::string json      = argc > 5 ? argv[5] : "";
+    if (list.empty()) {
+        printf("no valid thread count in %s\n", argv[4]);
+        return -1;
+    }
+
+    // (name, param, bin) of every model to run
+    std::vector<std::vector<std::string>> targets;
+    if (EndsWith(models, ".param")) {
+        const std::string stem = models.substr(0, models.size() - strlen(".param"));
+        targets.push_back({stem.substr(stem.find_last_of('/') + 1), models, stem + ".bin"});
+    } else {
+        for (const char* name : BUNDLED_MODELS) {
+            const std::string stem = models + "/" + name;
+            targets.push_back({name, stem + ".param", stem + ".bin"});
+        }
+    }
+
+    std::vector<BenchResult> results;
+    for (const auto& target : targets) {
+        for (int threads : list) {
+            BenchResult result;
+            result.model   = target[0];
+            result.threads = threads;
+            result.measure =
+                RunIsolated(target[0], target[1], target[2], threads, warmup, iterations);
+            results.push_back(result);
+        }
+    }
+
+    // json on stdout keeps it to itself, the table moves to stderr
+    FILE* table = json == "-" ? stderr : stdout;
+    fprintf(table, "warmup %i, iterations %i\n", warmup, iterations);
+    fprintf(table,
+            "%-24s %7s %10s %10s %10s %10s %12s %10s\n",
+            "model",
+            "threads",
+            "min_ms",
+            "median_ms",
+            "p99_ms",
+            "mean_ms",
+            "samples/s",
+            "rss_mb");
+    int failed = 0;
+    for (const auto& result : results) {
+        const Measure& r = result.measure;
+        if (r.status != RUN_OK) {
+            fprintf(table,
+                    "%-24s %7i %s (%s)\n",
+                    result.model.c_str(),
+                    result.threads,
+                    StatusName(r.status),
+                    r.error);
+            failed += r.status == RUN_FAILED;
+            continue;
+        }
+        fprintf(table,
+                "%-24s %7i %10.3f %10.3f %10.3f %10.3f %12.1f %10.1f\n",
+                result.model.c_str(),
+                result.threads,
+                r.min_us * 1e-3,
+                r.median_us * 1e-3,
+                r.p99_us * 1e-3,
+                r.mean_us * 1e-3,
+                r.throughput,
+                r.peak_rss_kb / 1024.0);
+    }
+
+    if (!json.empty()) {
+        const std::string text = ToJson(results, warmup, iterations);
+        if (json == "-") {
+            printf("%s", text.c_str());
+        } else {
+            FILE* fp = fopen(json.c_str(), "wb");
+            if (!fp || fwrite(text.data(), text.size(), 1, fp) != 1) {
+                fprintf(stderr, "write %s failed\n", json.c_str());
+                failed = static_cast<int>(results.size());
+            }
+            if (fp) {
+                fclose(fp);
+            }
+        }
+    }
+    // a model that fails to run is a regression as well, a skipped one is not
+    return failed ? -1 : 0;
+}
@@ -1,8 +1,94 @@
 #include "infer.h"
 
+#include "runtime/stream.h"
+
+#include <chrono>
+#include <cstring>
 #include <log.h>
 
 namespace nn {
+namespace {
+// bytes of one element, 0 for a type the outputs are never kept in
+size_t ElemSize(DataType type) {
+    switch (type) {
+    case M_DATA_TYPE_FLOAT32:
+        return sizeof(float);
+    case M_DATA_TYPE_UINT8:
+        return sizeof(uint8_t);
+    default:
+        return 0;
+    }
+}
+} // namespace
+
+MStatus InferBase::InferContext::Wait() const {
+    if (!future_.valid()) {
+        SIMPLE_LOG_ERROR("InferContext::Wait no run was queued\n");
+        return MStatus::M_FAILED;
+    }
+    return future_.get();
+}
+
+bool InferBase::InferContext::IsDone() const {
+    return future_.valid() &&
+           future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+bool InferBase::InferContext::Begin() {
+    if (future_.valid() && !IsDone()) {
+        return false;
+    }
+    promise_ = std::promise<MStatus>();
+    future_  = promise_.get_future().share();
+    return true;
+}
+
+MStatus InferBase::InferContext::KeepOutputs(const std::vector<NNTensorPtr>& output,
+                                             const std::vector<bool>& bound) {
+    outputs_.resize(output.size());
+    copies_.resize(output.size());
+    for (size_t i = 0; i < output.size(); ++i) {
+        // the caller owns a bound tensor already and expects the next run to overwrite it
+        if (!output[i] || bound[i]) {
+            outputs_[i] = output[i];
+            continue;
+        }
+        const DataType type = output[i]->GetElemType();
+        const size_t size   = ElemSize(type);
+        if (!size) {
+            SIMPLE_LOG_ERROR("InferContext::KeepOutputs output %s type %s not support\n",
+                             output[i]->GetName().c_str(),
+                             DataTypeStr[type]);
+            return MStatus::M_NOT_SUPPORT;
+        }
+        const std::vector<uint32_t> shape = output[i]->GetShape();
+        if (!copies_[i] || copies_[i]->GetShape() != shape || copies_[i]->GetElemType() != type) {
+            const LayoutType layout = TENSOR_SHAPE_MODE_NHWC == output[i]->GetShapeMode()
+                                          ? M_LAYOUT_NHWC
+                                          : M_LAYOUT_NCHW;
+            copies_[i] = std::make_shared<base::Tensor>(shape, layout, M_MEM_ON_CPU, type);
+        }
+        size_t count = 1;
+        for (auto dim : shape) {
+            count *= dim;
+        }
+        memcpy(copies_[i]->GetData<uint8_t>(), output[i]->GetData<uint8_t>(), count * size);
+        copies_[i]->SetName(output[i]->GetName());
+        outputs_[i] = copies_[i];
+    }
+    return MStatus::M_OK;
+}
+
+void InferBase::InferContext::Complete(MStatus status) {
+    if (status != MStatus::M_OK) {
+        outputs_.clear();
+    }
+    if (callback_) {
+        callback_(status, outputs_);
+    }
+    promise_.set_value(status);
+}
+
 MStatus InferBase::SetInputsShapeSize(const std::vector<uint32_t>& sizes) {
     SIMPLE_LOG_ERROR("InferBase::SetInputsShapeSize not implement\n");
     return MStatus::M_FAILED;
@@ -32,8 +118,46 @@ MStatus InferBase::Run(void* stream,
                        std::shared_ptr<InferBase::InferContext>& infer_cxt,
                        const char* start,
                        const char* end) {
-    SIMPLE_LOG_ERROR("InferBase::Run not implement\n");
-    return MStatus::M_FAILED;
+    if (!infer_cxt) {
+        infer_cxt = std::make_shared<InferContext>();
+    }
+    if (!infer_cxt->Begin()) {
+        SIMPLE_LOG_ERROR("InferBase::Run context is still in flight\n");
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // the caller may release its strings and input vector as soon as this returns
+    std::string start_name = start ? start : "";
+    std::string end_name   = end ? end : "";
+    bool has_start         = start != nullptr;
+    bool has_end           = end != nullptr;
+    auto context           = infer_cxt;
+    auto inputs            = input;
+
+    Stream* executor = stream ? static_cast<Stream*>(stream) : Stream::GetDefault();
+    executor->Enqueue([this, context, inputs, start_name, end_name, has_start, has_end]() {
+        std::vector<NNTensorPtr> net_input = inputs;
+        std::vector<NNTensorPtr> output;
+        MStatus ret = MStatus::M_OK;
+        {
+            // the backend runs one queued run at a time whatever stream it came from, and the
+            // outputs it owns are copied before the next run overwrites them
+            std::lock_guard<std::mutex> lck(run_mutex_);
+            ret = Run(net_input,
+                      output,
+                      has_start ? start_name.c_str() : nullptr,
+                      has_end ? end_name.c_str() : nullptr);
+            if (ret == MStatus::M_OK) {
+                std::vector<bool> bound(output.size());
+                for (size_t i = 0; i < output.size(); ++i) {
+                    bound[i] = IsBoundOutput(output[i]);
+                }
+                ret = context->KeepOutputs(output, bound);
+            }
+        }
+        context->Complete(ret);
+    });
+    return MStatus::M_OK;
 }
 
 } // namespace nn
@@ -2,8 +2,11 @@
 #define SIMPLE_NN_INFER_H_
 
 #include <common.h>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <tensor/tensor.h>
 #include <vector>
@@ -17,10 +20,51 @@ public:
     using NNModelPackagePtr = std::shared_ptr<ModelPackage>;
 
 public:
+    /// @brief completion of one asynchronous Run, the status and outputs are valid once the
+    /// future is ready. a context may be reused once its previous run completed
     class InferContext {
+    public:
+        using Callback = std::function<void(MStatus status, std::vector<NNTensorPtr>& output)>;
+
     public:
         InferContext() {}
         virtual ~InferContext() {}
+
+        /// @brief called on the stream thread when the run completes, before the future is
+        /// ready, set it before the context is passed to Run
+        void SetCallback(const Callback& callback) { callback_ = callback; }
+
+        /// @brief status of the run, ready once it completed
+        std::shared_future<MStatus> GetFuture() const { return future_; }
+
+        /// @brief block until the run completed and return its status
+        MStatus Wait() const;
+
+        bool IsDone() const;
+
+        /// @brief outputs of the completed run. a tensor the caller bound with SetTensorByName
+        /// is handed through as is, any other is a copy owned by the context so later runs of
+        /// the backend leave it alone. the next run on this context reuses the copies when the
+        /// shapes and element types match
+        std::vector<NNTensorPtr>& GetOutputs() { return outputs_; }
+
+    private:
+        friend class InferBase;
+
+        // arm the context for a new run, false while the previous one is in flight
+        bool Begin();
+        // hand through the backend outputs the caller bound and copy the others into the
+        // context tensors
+        MStatus KeepOutputs(const std::vector<NNTensorPtr>& output, const std::vector<bool>& bound);
+        void Complete(MStatus status);
+
+    private:
+        Callback callback_{nullptr};
+        std::promise<MStatus> promise_;
+        std::shared_future<MStatus> future_;
+        std::vector<NNTensorPtr> outputs_;
+        // the copies behind outputs_, kept apart so a tensor handed through is never written
+        std::vector<NNTensorPtr> copies_;
     };
 
     virtual MStatus Init(const std::string& path, const ModelConfig& config)          = 0;
@@ -32,6 +76,13 @@ public:
                         std::vector<NNTensorPtr>& output,
                         const char* start = nullptr,
                         const char* end   = nullptr) = 0;
+    /// @brief queue a run on a stream and return right away, completion is signalled through
+    /// infer_cxt. the default runs the synchronous Run in order on a Stream, backends with a
+    /// native queue override it. runs of one backend queued on several streams take turns,
+    /// the overlap is with the caller and with other backends. the inputs must not change and
+    /// the backend must stay alive until the run completed
+    /// @param stream a Stream*, nullptr for the process wide default stream
+    /// @param infer_cxt context to signal, created when empty
     virtual MStatus Run(void* stream,
                         std::vector<NNTensorPtr>& input,
                         std::shared_ptr<InferBase::InferContext>& infer_cxt,
@@ -41,10 +92,13 @@ public:
 
     virtual MStatus SetOutputsShapeSize(const std::vector<uint32_t>& sizes);
 
+    /// @brief bind a caller tensor to a named input or output, later runs read or write it in
+    /// place instead of allocating and copying
     virtual MStatus SetTensorByName(const NNTensorPtr& tensor, const std::string& name);
 
     virtual MStatus GetTensorByName(NNTensorPtr& tensor, const std::string& name);
 
+    /// @brief bind one tensor per input by position, a Run with no input then uses them
     virtual MStatus SetInputs(std::vector<NNTensorPtr>& tensors);
 
 
@@ -57,11 +111,19 @@ public:
     virtual std::vector<uint32_t> GetOutputDims(uint32_t idx) const = 0;
 
 protected:
+    /// @brief whether a run output is a tensor the caller bound with SetTensorByName, the
+    /// asynchronous Run hands those through instead of copying them
+    virtual bool IsBoundOutput(const NNTensorPtr& tensor) const { return false; }
+
     void SetModelName(const std::string& name) { model_name_ = name; }
     std::string model_name_{};
     std::vector<std::string> output_layer_name_{};
 
     std::shared_ptr<NNModel> row_model_{nullptr};
+
+private:
+    // held by the queued runs, a backend runs one of them at a time
+    std::mutex run_mutex_;
 };
 
 using InferBasePtr    = std::shared_ptr<InferBase>;
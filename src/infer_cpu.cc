@@ -0,0 +1,286 @@
+#include "infer_cpu.h"
+
+#include <algorithm>
+#include <cstring>
+#include <log.h>
+
+namespace nn {
+namespace {
+const char PARAM_SUFFIX[] = ".param";
+const char BIN_SUFFIX[]   = ".bin";
+
+bool EndsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::vector<uint32_t> ToDims(const std::vector<int>& shape) {
+    std::vector<uint32_t> dims(shape.begin(), shape.end());
+    while (dims.size() < 4) {
+        dims.push_back(1);
+    }
+    return dims;
+}
+} // namespace
+
+InferCpu::InferCpu() {}
+
+InferCpu::~InferCpu() {}
+
+void InferCpu::SetConfig(const ModelConfig& config) {
+    SIMPLE_LOG_DEBUG("InferCpu::SetConfig : %p\n", config.engine_context);
+    option_ = std::make_shared<NetOption>();
+    if (config.engine_context) {
+        *option_ = *reinterpret_cast<const NetOption*>(config.engine_context);
+    }
+}
+
+MStatus InferCpu::LoadNet(const std::string& param, const std::string& bin) {
+    net_.reset(new Net(model_name_, option_));
+    MStatus ret = bin.empty() ? net_->LoadCompiled(param) : net_->Init(param, bin);
+    if (ret != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("InferCpu load %s failed\n", param.c_str());
+        net_.reset();
+        return ret;
+    }
+
+    output_layer_name_.clear();
+    for (size_t i = 0; i < net_->GetOutputNum(); ++i) {
+        output_layer_name_.push_back(net_->GetOutputName(i));
+    }
+    return MStatus::M_OK;
+}
+
+MStatus InferCpu::Init(const std::string& path, const ModelConfig& config) {
+    SIMPLE_LOG_DEBUG("InferCpu::Init Start, %s\n", path.c_str());
+    SetConfig(config);
+    std::string bin;
+    if (EndsWith(path, PARAM_SUFFIX)) {
+        bin = path.substr(0, path.size() - strlen(PARAM_SUFFIX)) + BIN_SUFFIX;
+    }
+    MStatus ret = LoadNet(path, bin);
+    SIMPLE_LOG_DEBUG("InferCpu::Init End, %s\n", path.c_str());
+    return ret;
+}
+
+MStatus InferCpu::Init(NNModelPackagePtr model_resource, const ModelConfig& config) {
+    SIMPLE_LOG_DEBUG("InferCpu::Init Start\n");
+    MStatus ret = MStatus::M_OK;
+    do {
+        if (!model_resource || model_resource->GetModels().empty()) {
+            SIMPLE_LOG_ERROR("InferCpu::Init empty model package\n");
+            ret = MStatus::M_INVALID_ARG;
+            break;
+        }
+        SetConfig(config);
+
+        // the net maps its files itself, so only the paths of the package are used
+        std::string param;
+        std::string bin;
+        for (const auto& model : model_resource->GetModels()) {
+            if (EndsWith(model->Path(), PARAM_SUFFIX)) {
+                param = model->Path();
+            } else if (EndsWith(model->Path(), BIN_SUFFIX)) {
+                bin = model->Path();
+            }
+        }
+        if (param.empty() != bin.empty()) {
+            SIMPLE_LOG_ERROR("InferCpu::Init package needs both the .param and the .bin\n");
+            ret = MStatus::M_INVALID_ARG;
+            break;
+        }
+        if (param.empty()) {
+            if (model_resource->GetModels().size() != 1) {
+                SIMPLE_LOG_ERROR("InferCpu::Init package holds %i models, expect one compiled\n",
+                                 model_resource->GetModels().size());
+                ret = MStatus::M_INVALID_ARG;
+                break;
+            }
+            param = model_resource->GetModels()[0]->Path();
+        }
+        ret = LoadNet(param, bin);
+    } while (0);
+    SIMPLE_LOG_DEBUG("InferCpu::Init End\n");
+    return ret;
+}
+
+MStatus InferCpu::CheckInput(const NNTensorPtr& tensor, const std::string& name) const {
+    if (nullptr == tensor) {
+        SIMPLE_LOG_ERROR("net tensor %s is nullptr\n", name.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    if (tensor->GetElemType() != M_DATA_TYPE_FLOAT32) {
+        SIMPLE_LOG_ERROR("net tensor %s not support %s data type\n",
+                         name.c_str(),
+                         DataTypeStr[tensor->GetElemType()]);
+        return MStatus::M_NOT_SUPPORT;
+    }
+    if (tensor->GetMemType() != M_MEM_ON_CPU) {
+        SIMPLE_LOG_ERROR("net tensor %s not support %s memory type\n",
+                         name.c_str(),
+                         MemTypeStr[tensor->GetMemType()]);
+        return MStatus::M_NOT_SUPPORT;
+    }
+    return MStatus::M_OK;
+}
+
+MStatus InferCpu::Run(std::vector<NNTensorPtr>& input,
+                      std::vector<NNTensorPtr>& output,
+                      const char* start,
+                      const char* end) {
+    SIMPLE_LOG_DEBUG("InferCpu::Run Start\n");
+    MStatus ret = MStatus::M_OK;
+    do {
+        if (!net_) {
+            SIMPLE_LOG_ERROR("InferCpu::Run net is not initialized\n");
+            ret = MStatus::M_FAILED;
+            break;
+        }
+        if (start) {
+            SIMPLE_LOG_ERROR("InferCpu::Run start layer %s not support\n", start);
+            ret = MStatus::M_NOT_SUPPORT;
+            break;
+        }
+
+        if (!input.empty()) {
+            ret = SetInputs(input);
+            if (ret != MStatus::M_OK) {
+                break;
+            }
+        }
+
+        // stopping early only runs the layers the requested blob depends on
+        if (end) {
+            NNTensorPtr tensor;
+            ret = net_->Extract(end, tensor);
+            if (ret != MStatus::M_OK) {
+                SIMPLE_LOG_ERROR("InferCpu::Run extract %s failed\n", end);
+                break;
+            }
+            output.assign(1, tensor);
+            break;
+        }
+
+        ret = net_->Forward();
+        if (ret != MStatus::M_OK) {
+            SIMPLE_LOG_ERROR("InferCpu::Run forward failed\n");
+            break;
+        }
+        output.resize(net_->GetOutputNum());
+        for (size_t i = 0; i < output.size() && ret == MStatus::M_OK; ++i) {
+            ret = net_->GetOutput(net_->GetOutputName(i), output[i]);
+        }
+    } while (0);
+    SIMPLE_LOG_DEBUG("InferCpu::Run End\n");
+    return ret;
+}
+
+uint32_t InferCpu::GetInputNum() const {
+    return net_ ? static_cast<uint32_t>(net_->GetInputNum()) : 0;
+}
+
+uint32_t InferCpu::GetOutputNum() const {
+    return net_ ? static_cast<uint32_t>(net_->GetOutputNum()) : 0;
+}
+
+MStatus InferCpu::SetTensorByName(const NNTensorPtr& tensor, const std::string& name) {
+    if (!net_) {
+        SIMPLE_LOG_ERROR("InferCpu::SetTensorByName net is not initialized\n");
+        return MStatus::M_FAILED;
+    }
+    MStatus ret = CheckInput(tensor, name);
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+    if (net_->GetOutputIndex(name) >= 0) {
+        return net_->SetOutput(name, tensor);
+    }
+    return net_->SetInput(name, tensor);
+}
+
+bool InferCpu::IsBoundOutput(const NNTensorPtr& tensor) const {
+    return net_ && net_->IsBoundOutput(tensor);
+}
+
+MStatus InferCpu::SetInputs(std::vector<NNTensorPtr>& tensors) {
+    if (!net_) {
+        SIMPLE_LOG_ERROR("InferCpu::SetInputs net is not initialized\n");
+        return MStatus::M_FAILED;
+    }
+    if (tensors.size() != net_->GetInputNum()) {
+        SIMPLE_LOG_ERROR("input tensor num not equal net input: %ivs%i\n",
+                         tensors.size(),
+                         net_->GetInputNum());
+        return MStatus::M_INVALID_ARG;
+    }
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        MStatus ret = CheckInput(tensors[i], net_->GetInputName(i));
+        if (ret == MStatus::M_OK) {
+            ret = net_->SetInput(i, tensors[i]);
+        }
+        if (ret != MStatus::M_OK) {
+            return ret;
+        }
+    }
+    return MStatus::M_OK;
+}
+
+MStatus InferCpu::SetInputsShapeSize(const std::vector<uint32_t>& sizes) {
+    if (!net_) {
+        SIMPLE_LOG_ERROR("InferCpu::SetInputsShapeSize net is not initialized\n");
+        return MStatus::M_FAILED;
+    }
+    // the dims of every input as GetInputDims returns them, the padding of lower ranks is
+    // dropped again
+    std::vector<std::vector<int>> shapes(net_->GetInputNum());
+    size_t offset = 0;
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const size_t rank  = net_->GetInputShape(i).size();
+        const size_t count = std::max<size_t>(rank, 4);
+        for (size_t j = 0; j < count && offset + j < sizes.size(); ++j) {
+            const uint32_t dim = sizes[offset + j];
+            if (j < rank) {
+                shapes[i].push_back(static_cast<int>(dim));
+            } else if (dim != 1) {
+                SIMPLE_LOG_ERROR("InferCpu::SetInputsShapeSize input %i has rank %i\n", i, rank);
+                return MStatus::M_INVALID_ARG;
+            }
+        }
+        offset += count;
+    }
+    if (offset != sizes.size()) {
+        SIMPLE_LOG_ERROR("InferCpu::SetInputsShapeSize expect %i dims, got %i\n",
+                         offset,
+                         sizes.size());
+        return MStatus::M_INVALID_ARG;
+    }
+    return net_->Reshape(shapes);
+}
+
+MStatus InferCpu::GetTensorByName(NNTensorPtr& tensor, const std::string& name) {
+    if (!net_) {
+        SIMPLE_LOG_ERROR("InferCpu::GetTensorByName net is not initialized\n");
+        return MStatus::M_FAILED;
+    }
+    if (net_->GetOutputIndex(name) >= 0) {
+        return net_->GetOutput(name, tensor);
+    }
+    return net_->Extract(name, tensor);
+}
+
+std::vector<uint32_t> InferCpu::GetInputDims(uint32_t idx) const {
+    if (!net_ || idx >= net_->GetInputNum()) {
+        SIMPLE_LOG_ERROR("InferCpu::GetInputDims invalid input %i\n", idx);
+        return {};
+    }
+    return ToDims(net_->GetCurrentInputShape(idx));
+}
+
+std::vector<uint32_t> InferCpu::GetOutputDims(uint32_t idx) const {
+    if (!net_ || idx >= net_->GetOutputNum()) {
+        SIMPLE_LOG_ERROR("InferCpu::GetOutputDims invalid output %i\n", idx);
+        return {};
+    }
+    return ToDims(net_->GetCurrentOutputShape(idx));
+}
+} // namespace nn
@@ -0,0 +1,79 @@
+#ifndef SIMPLE_NN_CPU_INFER_H_
+#define SIMPLE_NN_CPU_INFER_H_
+
+#include "infer.h"
+#include "runtime/net.h"
+
+namespace nn {
+/// @brief InferBase backend running the native Net on the cpu. a model is either a pnnx
+/// param/bin pair or a compiled model written by Net::SaveCompiled. ModelConfig::engine_context
+/// may point to a NetOption, the default option is used when it is null
+class InferCpu : public InferBase {
+public:
+    InferCpu();
+    ~InferCpu();
+
+    /// @param path xxx.pnnx.param with its xxx.pnnx.bin next to it, any other path is loaded as
+    /// a compiled model
+    MStatus Init(const std::string& path, const ModelConfig& config) override;
+    /// @brief the package holds either a .param and a .bin model or a single compiled model,
+    /// they are loaded from their paths
+    MStatus Init(NNModelPackagePtr model_resource, const ModelConfig& config) override;
+
+    /// @brief run the net, outputs are in net output order, either the tensors bound by
+    /// SetTensorByName or tensors owned by the backend that the next run overwrites
+    /// @param input one tensor per net input, empty to use the inputs bound by SetInputs or
+    /// SetTensorByName
+    /// @param start not supported, the net always starts at its inputs
+    /// @param end name of a blob or layer output to stop at, only the layers it depends on
+    /// run and it is returned as the single output
+    using InferBase::Run;
+    MStatus Run(std::vector<NNTensorPtr>& input,
+                std::vector<NNTensorPtr>& output,
+                const char* start = nullptr,
+                const char* end   = nullptr) override;
+
+    uint32_t GetInputNum() const override;
+    uint32_t GetOutputNum() const override;
+
+    /// @brief bind an input or an output by name. an input is read in place by later runs with
+    /// no input, an output is written in place by every later run and returned as the output
+    MStatus SetTensorByName(const NNTensorPtr& tensor, const std::string& name) override;
+
+    MStatus SetInputs(std::vector<NNTensorPtr>& tensors) override;
+
+    /// @brief switch to new input shapes before running them, GetInputDims and GetOutputDims
+    /// report the new shapes afterwards. inputs of another size given to Run or SetInputs
+    /// switch the shapes on their own, this only plans ahead and allows sizing the outputs
+    /// @param sizes the dims of every input in input order, as GetInputDims returns them
+    MStatus SetInputsShapeSize(const std::vector<uint32_t>& sizes) override;
+
+    /// @brief output of the last run, or any other blob computed on demand
+    MStatus GetTensorByName(NNTensorPtr& tensor, const std::string& name) override;
+
+    /// @brief get the four-dimensional (nchw) of the idx-th input blob, lower ranks are padded
+    /// with trailing 1
+    /// @param[in] idx blob的index
+    std::vector<uint32_t> GetInputDims(uint32_t idx) const override;
+
+    /// @brief get the four-dimensional (nchw) of the idx-th output blob, lower ranks are padded
+    /// with trailing 1
+    /// @param[in] idx blob的index
+    std::vector<uint32_t> GetOutputDims(uint32_t idx) const override;
+
+protected:
+    bool IsBoundOutput(const NNTensorPtr& tensor) const override;
+
+private:
+    void SetConfig(const ModelConfig& config);
+    // a pnnx model when bin is set, a compiled model otherwise
+    MStatus LoadNet(const std::string& param, const std::string& bin);
+    MStatus CheckInput(const NNTensorPtr& tensor, const std::string& name) const;
+
+private:
+    std::shared_ptr<NetOption> option_{nullptr};
+    std::unique_ptr<Net> net_{nullptr};
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_CPU_INFER_H_
@@ -217,6 +217,7 @@ MStatus InferQnn::ReArrangeInput(std::vector<NNTensorPtr>& input) {
         }
     } while (0);
     SIMPLE_LOG_DEBUG("InferQnn::ReArrangeInput End\n");
+    return ret;
 }
 
 MStatus InferQnn::ReArrangeOutput(std::vector<NNTensorPtr>& output) {
@@ -226,7 +227,7 @@ MStatus InferQnn::ReArrangeOutput(std::vector<NNTensorPtr>& output) {
         for (size_t i = 0; i < output.size(); ++i) {
             if (std::find(output_layer_name_.begin(),
                           output_layer_name_.end(),
-                          output[i]->GetName()) != output_layer_name_.end()) {
+                          output[i]->GetName()) == output_layer_name_.end()) {
                 SIMPLE_LOG_ERROR("%s tensor not find in output_layer_name\n",
                                  output[i]->GetName().c_str());
                 ret = MStatus::M_FILE_NOT_FOUND;
@@ -241,7 +242,6 @@ MStatus InferQnn::ReArrangeOutput(std::vector<NNTensorPtr>& output) {
                     break;
                 }
             }
-            break;
         }
     } while (0);
     SIMPLE_LOG_DEBUG("InferQnn::ReArrangeOutput End\n");
@@ -259,13 +259,26 @@ MStatus InferQnn::CreateNetOutput(const int batch_size, std::vector<NNTensorPtr>
             ret = MStatus::M_FAILED;
             break;
         }
+        // tensors of the previous run and tensors bound by the caller are written in place,
+        // a new one is only allocated when the batch size changes
         output.resize(net_output_dims.size());
+        output_bound_.resize(net_output_dims.size(), false);
         for (size_t i = 0; i < net_output_dims.size(); ++i) {
             std::vector<uint32_t> tensor_shape = {
                 static_cast<uint32_t>(batch_size * net_output_dims[i][0]),
                 static_cast<uint32_t>(net_output_dims[i][1]),
                 static_cast<uint32_t>(net_output_dims[i][2]),
                 static_cast<uint32_t>(net_output_dims[i][3])};
+            if (output[i] && output[i]->GetShape() == tensor_shape) {
+                continue;
+            }
+            if (output_bound_[i]) {
+                SIMPLE_LOG_ERROR("bound output %s does not hold a batch of %i\n",
+                                 net_output_names[i].c_str(),
+                                 batch_size);
+                ret = MStatus::M_INVALID_ARG;
+                break;
+            }
 
             output[i] = std::make_shared<base::Tensor>(
                 tensor_shape, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
@@ -311,6 +324,7 @@ MStatus InferQnn::CheckInputShape(std::vector<NNTensorPtr>& input) {
         }
     } while (0);
     SIMPLE_LOG_DEBUG("InferQnn::CheckInputShape End\n");
+    return ret;
 }
 
 MStatus InferQnn::RunSingleBatch(std::vector<NNTensorPtr>& input,
@@ -330,7 +344,8 @@ MStatus InferQnn::RunSingleBatch(std::vector<NNTensorPtr>& input,
     std::vector<uint8_t*> net_output_buffers(output.size(), nullptr);
     std::vector<size_t> net_output_buffers_len(output.size(), 0L);
     for (size_t i = 0; i < output.size(); ++i) {
-        auto net_dim = output[i]->GetShape();
+        // one batch of the graph, the tensor holds batch_size of them
+        auto net_dim = output_layer_dims_[i];
         net_output_buffers_len[i] =
             net_dim[0] * net_dim[1] * net_dim[2] * net_dim[3] * sizeof(float);
         net_output_buffers[i] = output[i]->GetData<uint8_t>() + batch * net_output_buffers_len[i];
@@ -384,7 +399,8 @@ MStatus InferQnn::Run(std::vector<NNTensorPtr>& input,
     SIMPLE_LOG_DEBUG("InferQnn::Run Start\n");
     MStatus ret = MStatus::M_OK;
     do {
-        auto net_input = input;
+        // a run without input uses the tensors bound by SetInputs or SetTensorByName
+        auto net_input = input.empty() ? input_tensors_ : input;
         ret            = CheckInputShape(net_input);
         if (ret != MStatus::M_OK) {
             SIMPLE_LOG_ERROR("CheckInputShape failed\n");
@@ -398,7 +414,7 @@ MStatus InferQnn::Run(std::vector<NNTensorPtr>& input,
         }
 
         const int batch_size = net_input[0]->GetShape(0) / GetInputDims(0)[0];
-        std::vector<NNTensorPtr> net_output;
+        std::vector<NNTensorPtr>& net_output = output_tensors_;
         ret = CreateNetOutput(batch_size, net_output);
         if (ret != MStatus::M_OK) {
             SIMPLE_LOG_ERROR("CreateNetOutput failed\n");
@@ -412,6 +428,9 @@ MStatus InferQnn::Run(std::vector<NNTensorPtr>& input,
                 break;
             }
         }
+        if (ret != MStatus::M_OK) {
+            break;
+        }
 
         ret = ReArrangeOutput(net_output);
         if (ret != MStatus::M_OK) {
@@ -421,6 +440,40 @@ MStatus InferQnn::Run(std::vector<NNTensorPtr>& input,
         output = output_tensors_;
     } while (0);
     SIMPLE_LOG_DEBUG("InferQnn::Run End\n");
+    return ret;
+}
+
+MStatus InferQnn::SetTensorByName(const NNTensorPtr& tensor, const std::string& name) {
+    if (nullptr == qnn_wrapper_ptr_ || nullptr == tensor) {
+        SIMPLE_LOG_ERROR("InferQnn::SetTensorByName %s invalid\n", name.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    auto output_names = qnn_wrapper_ptr_->getOutputNames();
+    size_t idx = std::find(output_names.begin(), output_names.end(), name) - output_names.begin();
+    if (idx < output_names.size()) {
+        // written in place by RunSingleBatch, ReArrangeOutput matches it by name
+        output_tensors_.resize(output_names.size());
+        output_bound_.resize(output_names.size(), false);
+        tensor->SetName(name);
+        output_tensors_[idx] = tensor;
+        output_bound_[idx]   = true;
+        return MStatus::M_OK;
+    }
+
+    auto input_names = qnn_wrapper_ptr_->getInputNames();
+    idx = std::find(input_names.begin(), input_names.end(), name) - input_names.begin();
+    if (idx < input_names.size()) {
+        input_tensors_.resize(input_names.size());
+        input_tensors_[idx] = tensor;
+        return MStatus::M_OK;
+    }
+    SIMPLE_LOG_ERROR("InferQnn::SetTensorByName no input or output named %s\n", name.c_str());
+    return MStatus::M_INVALID_ARG;
+}
+
+MStatus InferQnn::SetInputs(std::vector<NNTensorPtr>& tensors) {
+    input_tensors_ = tensors;
     return MStatus::M_OK;
 }
 
@@ -25,11 +25,19 @@ public:
     MStatus Init(const std::string& path, const ModelConfig& config) override;
     MStatus Init(NNModelPackagePtr model_resource, const ModelConfig& config) override;
 
+    // keep the asynchronous overload of the base visible
+    using InferBase::Run;
     MStatus Run(std::vector<NNTensorPtr>& input,
                 std::vector<NNTensorPtr>& output,
                 const char* start = nullptr,
                 const char* end   = nullptr) override;
 
+    /// @brief bind a caller tensor to a named input or output, a bound output is written in
+    /// place and must hold the batch of the inputs
+    MStatus SetTensorByName(const NNTensorPtr& tensor, const std::string& name) override;
+
+    MStatus SetInputs(std::vector<NNTensorPtr>& tensors) override;
+
     uint32_t GetInputNum() const override;
     uint32_t GetOutputNum() const override;
 
@@ -53,7 +61,11 @@ private:
 
 private:
     std::unique_ptr<wrap::QnnWrapperV1> qnn_wrapper_ptr_;
+    std::vector<NNTensorPtr> input_tensors_;
+    // outputs of the last run, reused by the next one
     std::vector<NNTensorPtr> output_tensors_;
+    // outputs bound by the caller, never reallocated
+    std::vector<bool> output_bound_;
     std::vector<std::vector<uint32_t>> output_layer_dims_;
     std::string backend_lib_path_;
     std::string system_lib_path_;
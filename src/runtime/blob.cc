@@ -1,5 +1,5 @@
 #include "runtime/blob.h"
 
 namespace nn {
-Blob::Blob() : name(""), producer(-1), consumer(-1), shape({}) {}
+Blob::Blob() : name(""), producer(-1), consumers({}), shape({}) {}
 } // namespace nn
\ No newline at end of file
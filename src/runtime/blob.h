@@ -15,10 +15,10 @@ public:
     std::string name;
     // layer index which produce this blob as output
     int producer;
-    // layer index which need this blob as input
-    int consumer;
+    // layer indices which need this blob as input
+    std::vector<int> consumers;
     // shape hint
-    std::vector<uint8_t> shape;
+    std::vector<int> shape;
 };
 } // namespace nn
 
@@ -0,0 +1,217 @@
+#include "runtime/compiled_model.h"
+
+#include "utils/aligned_buffer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <log.h>
+
+namespace nn {
+void CompiledWriter::WriteRaw(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    meta_.insert(meta_.end(), bytes, bytes + size);
+}
+
+void CompiledWriter::WriteInt(int64_t value) {
+    WriteRaw(&value, sizeof(value));
+}
+
+void CompiledWriter::WriteInts(const std::vector<int>& values) {
+    WriteInt(static_cast<int64_t>(values.size()));
+    WriteRaw(values.data(), values.size() * sizeof(int));
+}
+
+void CompiledWriter::WriteString(const std::string& value) {
+    WriteInt(static_cast<int64_t>(value.size()));
+    WriteRaw(value.data(), value.size());
+}
+
+void CompiledWriter::WriteParameter(const pnnx::Parameter& param) {
+    WriteInt(param.type);
+    switch (param.type) {
+    case 1:
+        WriteInt(param.b ? 1 : 0);
+        break;
+    case 2:
+        WriteInt(param.i);
+        break;
+    case 3:
+        WriteRaw(&param.f, sizeof(param.f));
+        break;
+    case 4:
+        WriteString(param.s);
+        break;
+    case 5:
+        WriteInts(param.ai);
+        break;
+    case 6:
+        WriteInt(static_cast<int64_t>(param.af.size()));
+        WriteRaw(param.af.data(), param.af.size() * sizeof(float));
+        break;
+    case 7:
+        WriteInt(static_cast<int64_t>(param.as.size()));
+        for (const auto& s : param.as) {
+            WriteString(s);
+        }
+        break;
+    case 10:
+        WriteRaw(&param.c, sizeof(param.c));
+        break;
+    case 11:
+        WriteInt(static_cast<int64_t>(param.ac.size()));
+        WriteRaw(param.ac.data(), param.ac.size() * sizeof(std::complex<float>));
+        break;
+    default:
+        break;
+    }
+}
+
+void CompiledWriter::WriteBuffer(const void* data, size_t size) {
+    const size_t offset = AlignSize(data_.size());
+    data_.resize(offset + size, 0);
+    if (size) {
+        memcpy(data_.data() + offset, data, size);
+    }
+    WriteInt(static_cast<int64_t>(offset));
+    WriteInt(static_cast<int64_t>(size));
+}
+
+MStatus CompiledWriter::Save(const std::string& path, CpuIsa isa, ExecutorMode mode) const {
+    CompiledModelHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COMPILED_MODEL_MAGIC, sizeof(header.magic));
+    header.version       = COMPILED_MODEL_VERSION;
+    header.cpu_isa       = static_cast<int32_t>(isa);
+    header.executor_mode = static_cast<int32_t>(mode);
+    header.meta_offset   = AlignSize(sizeof(header));
+    header.meta_size     = meta_.size();
+    header.data_offset   = AlignSize(header.meta_offset + header.meta_size);
+    header.data_size     = data_.size();
+
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp) {
+        SIMPLE_LOG_ERROR("CompiledWriter::Save open %s failed\n", path.c_str());
+        return MStatus::M_FAILED;
+    }
+    static const char padding[MEMORY_ALIGNMENT] = {0};
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(padding, header.meta_offset - sizeof(header), 1, fp) == 1;
+    ok = ok && (meta_.empty() || fwrite(meta_.data(), meta_.size(), 1, fp) == 1);
+    ok = ok && (header.data_offset == header.meta_offset + header.meta_size ||
+                fwrite(padding,
+                       header.data_offset - header.meta_offset - header.meta_size,
+                       1,
+                       fp) == 1);
+    ok = ok && (data_.empty() || fwrite(data_.data(), data_.size(), 1, fp) == 1);
+    if (fclose(fp) != 0 || !ok) {
+        SIMPLE_LOG_ERROR("CompiledWriter::Save write %s failed\n", path.c_str());
+        return MStatus::M_FAILED;
+    }
+    return MStatus::M_OK;
+}
+
+bool CompiledReader::ReadRaw(void* data, size_t size) {
+    if (static_cast<size_t>(end_ - cur_) < size) {
+        cur_ = end_;
+        return false;
+    }
+    memcpy(data, cur_, size);
+    cur_ += size;
+    return true;
+}
+
+bool CompiledReader::ReadCount(size_t& count, size_t elemsize) {
+    int64_t value = 0;
+    if (!ReadInt(value) || value < 0 ||
+        static_cast<uint64_t>(value) > static_cast<size_t>(end_ - cur_) / elemsize) {
+        return false;
+    }
+    count = static_cast<size_t>(value);
+    return true;
+}
+
+bool CompiledReader::ReadInt(int64_t& value) {
+    return ReadRaw(&value, sizeof(value));
+}
+
+bool CompiledReader::ReadInts(std::vector<int>& values) {
+    size_t count = 0;
+    if (!ReadCount(count, sizeof(int))) {
+        return false;
+    }
+    values.resize(count);
+    return ReadRaw(values.data(), count * sizeof(int));
+}
+
+bool CompiledReader::ReadString(std::string& value) {
+    size_t count = 0;
+    if (!ReadCount(count, 1)) {
+        return false;
+    }
+    value.assign(reinterpret_cast<const char*>(cur_), count);
+    cur_ += count;
+    return true;
+}
+
+bool CompiledReader::ReadParameter(pnnx::Parameter& param) {
+    param = pnnx::Parameter();
+    if (!ReadInt(param.type)) {
+        return false;
+    }
+    size_t count = 0;
+    switch (param.type) {
+    case 0:
+        return true;
+    case 1:
+        return ReadInt(param.b);
+    case 2:
+        return ReadInt(param.i);
+    case 3:
+        return ReadRaw(&param.f, sizeof(param.f));
+    case 4:
+        return ReadString(param.s);
+    case 5:
+        return ReadInts(param.ai);
+    case 6:
+        if (!ReadCount(count, sizeof(float))) {
+            return false;
+        }
+        param.af.resize(count);
+        return ReadRaw(param.af.data(), count * sizeof(float));
+    case 7:
+        if (!ReadCount(count, sizeof(int64_t))) {
+            return false;
+        }
+        param.as.resize(count);
+        for (auto& s : param.as) {
+            if (!ReadString(s)) {
+                return false;
+            }
+        }
+        return true;
+    case 10:
+        return ReadRaw(&param.c, sizeof(param.c));
+    case 11:
+        if (!ReadCount(count, sizeof(std::complex<float>))) {
+            return false;
+        }
+        param.ac.resize(count);
+        return ReadRaw(param.ac.data(), count * sizeof(std::complex<float>));
+    default:
+        return false;
+    }
+}
+
+bool CompiledReader::ReadBuffer(const void*& data, size_t& size) {
+    int64_t offset = 0;
+    int64_t length = 0;
+    if (!ReadInt(offset) || !ReadInt(length) || offset < 0 || length < 0 ||
+        static_cast<uint64_t>(offset) > data_size_ ||
+        static_cast<uint64_t>(length) > data_size_ - offset) {
+        return false;
+    }
+    data = length ? data_ + offset : nullptr;
+    size = static_cast<size_t>(length);
+    return true;
+}
+} // namespace nn
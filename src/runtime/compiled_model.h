@@ -0,0 +1,99 @@
+#ifndef SIMPLE_NN_COMPILED_MODEL_H_
+#define SIMPLE_NN_COMPILED_MODEL_H_
+
+#include "runtime/cpu.h"
+#include "runtime/net_option.h"
+#include "runtime/pnnx/ir.h"
+
+#include <common.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nn {
+// bumped whenever the file layout or the record of any layer changes
+constexpr uint32_t COMPILED_MODEL_VERSION = 1;
+constexpr char COMPILED_MODEL_MAGIC[8]    = {'S', 'N', 'N', 'C', 'O', 'M', 'P', '\0'};
+
+/// @brief first 64 bytes of a compiled model. the meta section is a flat stream of records
+/// describing blobs, layers and the plan, the data section holds the kernel ready weight
+/// buffers the records refer to, each one starting on a 64 byte boundary of the file
+struct CompiledModelHeader {
+    char magic[8];
+    uint32_t version;
+    // CpuIsa the weights were packed for, loads on every level running the same gemm kernel
+    int32_t cpu_isa;
+    // ExecutorMode the arena offsets were planned for
+    int32_t executor_mode;
+    uint32_t reserved;
+    uint64_t meta_offset;
+    uint64_t meta_size;
+    uint64_t data_offset;
+    uint64_t data_size;
+};
+
+/// @brief builds the two sections of a compiled model in memory, Save writes the file
+class CompiledWriter {
+public:
+    CompiledWriter()  = default;
+    ~CompiledWriter() = default;
+
+    void WriteInt(int64_t value);
+    void WriteInts(const std::vector<int>& values);
+    void WriteString(const std::string& value);
+    void WriteParameter(const pnnx::Parameter& param);
+
+    /// @brief copy size bytes to the next aligned offset of the data section, the meta
+    /// record only keeps offset and size
+    void WriteBuffer(const void* data, size_t size);
+
+    MStatus Save(const std::string& path, CpuIsa isa, ExecutorMode mode) const;
+
+private:
+    void WriteRaw(const void* data, size_t size);
+
+private:
+    std::vector<char> meta_;
+    std::vector<char> data_;
+};
+
+/// @brief reads the records of a mapped compiled model in the order they were written, every
+/// read is bounds checked and fails once the stream is exhausted or corrupt
+class CompiledReader {
+public:
+    CompiledReader(const uint8_t* meta, size_t meta_size, const uint8_t* data, size_t data_size)
+        : cur_(meta), end_(meta + meta_size), data_(data), data_size_(data_size) {}
+    ~CompiledReader() = default;
+
+    bool ReadInt(int64_t& value);
+    template <typename T>
+    bool ReadInt(T& value) {
+        int64_t raw = 0;
+        if (!ReadInt(raw)) {
+            return false;
+        }
+        value = static_cast<T>(raw);
+        return true;
+    }
+    /// @brief element count of a record, bounded by the bytes left so a corrupt count can not
+    /// trigger a huge allocation
+    bool ReadCount(size_t& count, size_t elemsize = 1);
+    bool ReadInts(std::vector<int>& values);
+    bool ReadString(std::string& value);
+    bool ReadParameter(pnnx::Parameter& param);
+
+    /// @brief view of a buffer stored by WriteBuffer, it lives as long as the mapping
+    bool ReadBuffer(const void*& data, size_t& size);
+
+private:
+    bool ReadRaw(void* data, size_t size);
+
+private:
+    const uint8_t* cur_;
+    const uint8_t* end_;
+    const uint8_t* data_;
+    size_t data_size_;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_COMPILED_MODEL_H_
@@ -0,0 +1,102 @@
+#include "runtime/cpu.h"
+
+#include <cstdint>
+#include <log.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace nn {
+namespace {
+#if defined(__x86_64__) || defined(__i386__)
+uint64_t ReadXcr0() {
+    uint32_t eax = 0;
+    uint32_t edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
+CpuIsa DetectCpuIsa() {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return CpuIsa::M_GENERIC;
+    }
+    const bool sse42   = ecx & (1u << 20);
+    const bool fma     = ecx & (1u << 12);
+    const bool osxsave = ecx & (1u << 27);
+    const bool avx     = ecx & (1u << 28);
+
+    CpuIsa isa = sse42 ? CpuIsa::M_SSE42 : CpuIsa::M_GENERIC;
+    if (!osxsave || !avx) {
+        return isa;
+    }
+
+    // the os must save ymm (xcr0 bits 1-2) and zmm/opmask (bits 5-7) state
+    const uint64_t xcr0 = ReadXcr0();
+    if ((xcr0 & 0x6) != 0x6 || __get_cpuid_max(0, nullptr) < 7) {
+        return isa;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    const bool avx2     = ebx & (1u << 5);
+    const bool avx512f  = ebx & (1u << 16);
+    const bool avx512dq = ebx & (1u << 17);
+    const bool avx512bw = ebx & (1u << 30);
+    const bool avx512vl = ebx & (1u << 31);
+    const bool vnni     = ecx & (1u << 11);
+
+    if (avx2 && fma) {
+        isa = CpuIsa::M_AVX2;
+    }
+    if (isa == CpuIsa::M_AVX2 && (xcr0 & 0xe6) == 0xe6 && avx512f && avx512dq && avx512bw &&
+        avx512vl) {
+        isa = vnni ? CpuIsa::M_AVX512_VNNI : CpuIsa::M_AVX512;
+    }
+    return isa;
+}
+#else
+CpuIsa DetectCpuIsa() {
+    return CpuIsa::M_GENERIC;
+}
+#endif
+} // namespace
+
+CpuIsa GetHostCpuIsa() {
+    static const CpuIsa isa = [] {
+        CpuIsa detected = DetectCpuIsa();
+        SIMPLE_LOG_INFO("host cpu isa: %s\n", CpuIsaName(detected));
+        return detected;
+    }();
+    return isa;
+}
+
+CpuIsa ResolveCpuIsa(CpuIsa requested) {
+    CpuIsa best = GetHostCpuIsa();
+#ifndef CONFIG_SIMPLE_NN_ENABLE_X86
+    // no simd kernels were compiled into the library
+    best = CpuIsa::M_GENERIC;
+#endif
+    if (requested == CpuIsa::M_AUTO) {
+        return best;
+    }
+    if (static_cast<int>(requested) > static_cast<int>(best)) {
+        SIMPLE_LOG_WARN("cpu isa %s not available, fall back to %s\n",
+                        CpuIsaName(requested),
+                        CpuIsaName(best));
+        return best;
+    }
+    return requested;
+}
+
+const char* CpuIsaName(CpuIsa isa) {
+    switch (isa) {
+        case CpuIsa::M_AUTO: return "auto";
+        case CpuIsa::M_GENERIC: return "generic";
+        case CpuIsa::M_SSE42: return "sse4.2";
+        case CpuIsa::M_AVX2: return "avx2";
+        case CpuIsa::M_AVX512: return "avx512";
+        case CpuIsa::M_AVX512_VNNI: return "avx512-vnni";
+    }
+    return "unknown";
+}
+} // namespace nn
@@ -0,0 +1,26 @@
+#ifndef SIMPLE_NN_CPU_H_
+#define SIMPLE_NN_CPU_H_
+
+namespace nn {
+/// @brief x86 kernel levels, every level implies the ones below it
+enum class CpuIsa {
+    // let the runtime pick the best level of the host
+    M_AUTO = -1,
+    M_GENERIC = 0,
+    M_SSE42,
+    M_AVX2,
+    M_AVX512,
+    M_AVX512_VNNI,
+};
+
+/// @brief best level supported by the host cpu and os, detected once through cpuid
+CpuIsa GetHostCpuIsa();
+
+/// @brief level kernels should use for a requested one, M_AUTO and levels the host or the
+/// build can not run fall back to the best available
+CpuIsa ResolveCpuIsa(CpuIsa requested);
+
+const char* CpuIsaName(CpuIsa isa);
+} // namespace nn
+
+#endif // SIMPLE_NN_CPU_H_
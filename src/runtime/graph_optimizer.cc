@@ -0,0 +1,268 @@
+#include "runtime/graph_optimizer.h"
+
+#include "runtime/layer/conv2d.h"
+#include "runtime/layer/elementwise.h"
+#include "runtime/layer/linear.h"
+
+#include <algorithm>
+#include <cmath>
+#include <log.h>
+
+namespace nn {
+namespace {
+bool IsBatchNorm(const pnnx::Operator* op) {
+    return op->type == "nn.BatchNorm1d" || op->type == "nn.BatchNorm2d";
+}
+
+// activation name as read back by Layer::InitActivation, empty for other ops
+std::string ActivationName(const pnnx::Operator* op) {
+    if (op->type == "nn.ReLU" || op->type == "F.relu") {
+        return "relu";
+    }
+    if (op->type == "nn.SiLU" || op->type == "F.silu") {
+        return "silu";
+    }
+    if (op->type == "nn.LeakyReLU" || op->type == "F.leaky_relu") {
+        return "leaky_relu";
+    }
+    return "";
+}
+
+float NegativeSlope(const pnnx::Operator* op) {
+    auto slope = op->params.find("negative_slope");
+    return slope != op->params.end() ? slope->second.f : 0.01f;
+}
+
+// producer of the single input of op when op is its only consumer, so op can be folded
+// into it without another consumer seeing the difference
+pnnx::Operator* SoleProducer(const pnnx::Operator* op) {
+    if (op->inputs.size() != 1 || op->outputs.size() != 1) {
+        return nullptr;
+    }
+    pnnx::Operand* x = op->inputs[0];
+    if (!x->producer || x->producer->outputs.size() != 1 || x->consumers.size() != 1) {
+        return nullptr;
+    }
+    return x->producer;
+}
+
+// producer takes over the output of op, op and the operand between them are deleted
+void RemoveIntoProducer(pnnx::Graph& graph, pnnx::Operator* producer, pnnx::Operator* op) {
+    pnnx::Operand* x = op->inputs[0];
+    pnnx::Operand* y = op->outputs[0];
+    producer->outputs[0] = y;
+    y->producer          = producer;
+    graph.ops.erase(std::find(graph.ops.begin(), graph.ops.end(), op));
+    graph.operands.erase(std::find(graph.operands.begin(), graph.operands.end(), x));
+    delete op;
+    delete x;
+}
+
+// y = x * scale + shift per channel of an inference batchnorm
+bool BatchNormAffine(const pnnx::Operator* bn, std::vector<float>& scale,
+                     std::vector<float>& shift) {
+    auto mean = bn->attrs.find("running_mean");
+    auto var  = bn->attrs.find("running_var");
+    if (mean == bn->attrs.end() || var == bn->attrs.end()) {
+        return false;
+    }
+    std::vector<float> mean_data = mean->second.get_float32_data();
+    std::vector<float> var_data  = var->second.get_float32_data();
+    if (mean_data.size() != var_data.size()) {
+        return false;
+    }
+    auto eps_param = bn->params.find("eps");
+    const float eps = eps_param != bn->params.end() ? eps_param->second.f : 1e-5f;
+
+    std::vector<float> gamma(mean_data.size(), 1.f);
+    std::vector<float> beta(mean_data.size(), 0.f);
+    auto weight = bn->attrs.find("weight");
+    auto bias   = bn->attrs.find("bias");
+    if (weight != bn->attrs.end() && bias != bn->attrs.end()) {
+        gamma = weight->second.get_float32_data();
+        beta  = bias->second.get_float32_data();
+        if (gamma.size() != mean_data.size() || beta.size() != mean_data.size()) {
+            return false;
+        }
+    }
+
+    scale.resize(mean_data.size());
+    shift.resize(mean_data.size());
+    for (size_t c = 0; c < mean_data.size(); ++c) {
+        scale[c] = gamma[c] / std::sqrt(var_data[c] + eps);
+        shift[c] = beta[c] - mean_data[c] * scale[c];
+    }
+    return true;
+}
+
+// output channels of conv/linear, the rows their weight is split into
+int OutputChannels(const pnnx::Operator* op) {
+    const char* key = op->type == kLinearType ? "out_features" : "out_channels";
+    auto channels   = op->params.find(key);
+    return channels != op->params.end() ? channels->second.i : 0;
+}
+} // namespace
+
+int GraphOptimizer::Optimize(pnnx::Graph& graph) const {
+    const size_t count = graph.ops.size();
+    int removed        = FoldBatchNorm(graph);
+    removed += FuseActivation(graph);
+    LowerElementwise(graph);
+    removed += MergeElementwise(graph);
+    SIMPLE_LOG_INFO("GraphOptimizer removed %i of %i ops\n", removed, count);
+    return removed;
+}
+
+int GraphOptimizer::FoldBatchNorm(pnnx::Graph& graph) const {
+    int folded = 0;
+    for (size_t i = 0; i < graph.ops.size();) {
+        pnnx::Operator* bn       = graph.ops[i];
+        pnnx::Operator* producer = IsBatchNorm(bn) ? SoleProducer(bn) : nullptr;
+        if (!producer || (producer->type != kConv2dType && producer->type != kLinearType) ||
+            producer->params.count("activation")) {
+            ++i;
+            continue;
+        }
+
+        std::vector<float> scale;
+        std::vector<float> shift;
+        auto weight        = producer->attrs.find("weight");
+        const int channels = OutputChannels(producer);
+        if (!BatchNormAffine(bn, scale, shift) || weight == producer->attrs.end() ||
+            channels <= 0 || scale.size() != static_cast<size_t>(channels) ||
+            weight->second.elemcount() % channels) {
+            ++i;
+            continue;
+        }
+
+        // W'[c] = W[c] * scale[c], b'[c] = b[c] * scale[c] + shift[c]
+        std::vector<float> weight_data = weight->second.get_float32_data();
+        const size_t row               = weight_data.size() / channels;
+        for (int c = 0; c < channels; ++c) {
+            for (size_t k = 0; k < row; ++k) {
+                weight_data[c * row + k] *= scale[c];
+            }
+        }
+        weight->second.set_float32_data(weight_data);
+
+        std::vector<float> bias_data(shift);
+        auto bias = producer->attrs.find("bias");
+        if (bias != producer->attrs.end() && bias->second.elemcount() == channels) {
+            bias_data = bias->second.get_float32_data();
+            for (int c = 0; c < channels; ++c) {
+                bias_data[c] = bias_data[c] * scale[c] + shift[c];
+            }
+        }
+        producer->attrs["bias"]  = pnnx::Attribute({channels}, bias_data);
+        producer->params["bias"] = pnnx::Parameter(true);
+
+        SIMPLE_LOG_DEBUG("GraphOptimizer fold %s into %s\n", bn->name.c_str(),
+                         producer->name.c_str());
+        RemoveIntoProducer(graph, producer, bn);
+        ++folded;
+    }
+    return folded;
+}
+
+int GraphOptimizer::FuseActivation(pnnx::Graph& graph) const {
+    int fused = 0;
+    for (size_t i = 0; i < graph.ops.size();) {
+        pnnx::Operator* op       = graph.ops[i];
+        const std::string name   = ActivationName(op);
+        pnnx::Operator* producer = name.empty() ? nullptr : SoleProducer(op);
+        if (!producer || (producer->type != kConv2dType && producer->type != kLinearType) ||
+            producer->params.count("activation")) {
+            ++i;
+            continue;
+        }
+
+        producer->params["activation"] = pnnx::Parameter(name);
+        if (name == "leaky_relu") {
+            producer->params["negative_slope"] = pnnx::Parameter(NegativeSlope(op));
+        }
+        SIMPLE_LOG_DEBUG("GraphOptimizer fuse %s into %s\n", op->name.c_str(),
+                         producer->name.c_str());
+        RemoveIntoProducer(graph, producer, op);
+        ++fused;
+    }
+    return fused;
+}
+
+void GraphOptimizer::LowerElementwise(pnnx::Graph& graph) const {
+    for (size_t i = 0; i < graph.ops.size(); ++i) {
+        pnnx::Operator* op     = graph.ops[i];
+        const std::string name = ActivationName(op);
+        if ((name.empty() && !IsBatchNorm(op)) || op->inputs.size() != 1 ||
+            op->outputs.size() != 1) {
+            continue;
+        }
+
+        std::vector<float> scale;
+        std::vector<float> shift;
+        if (name.empty() && !BatchNormAffine(op, scale, shift)) {
+            continue;
+        }
+
+        // the lowered op takes the place of the original in the op order
+        pnnx::Operator* lowered   = graph.new_operator_after(kElementwiseType, op->name, op);
+        lowered->inputs           = op->inputs;
+        lowered->outputs          = op->outputs;
+        lowered->params["stages"] = pnnx::Parameter(1);
+        if (name.empty()) {
+            const int channels        = static_cast<int>(scale.size());
+            lowered->attrs["0.scale"] = pnnx::Attribute({channels}, scale);
+            lowered->attrs["0.shift"] = pnnx::Attribute({channels}, shift);
+        } else {
+            lowered->params["0.activation"] = pnnx::Parameter(name);
+            if (name == "leaky_relu") {
+                lowered->params["0.negative_slope"] = pnnx::Parameter(NegativeSlope(op));
+            }
+        }
+
+        op->inputs[0]->remove_consumer(op);
+        op->inputs[0]->consumers.push_back(lowered);
+        op->outputs[0]->producer = lowered;
+        graph.ops.erase(graph.ops.begin() + i);
+        delete op;
+    }
+}
+
+int GraphOptimizer::MergeElementwise(pnnx::Graph& graph) const {
+    int merged = 0;
+    for (size_t i = 0; i < graph.ops.size();) {
+        pnnx::Operator* op       = graph.ops[i];
+        pnnx::Operator* producer = op->type == kElementwiseType ? SoleProducer(op) : nullptr;
+        if (!producer || producer->type != kElementwiseType) {
+            ++i;
+            continue;
+        }
+
+        // stage j of op becomes stage offset + j of producer
+        const int offset = producer->params["stages"].i;
+        const int count  = op->params["stages"].i;
+        for (int j = 0; j < count; ++j) {
+            const std::string from = std::to_string(j) + ".";
+            const std::string to   = std::to_string(offset + j) + ".";
+            for (const char* key : {"activation", "negative_slope"}) {
+                auto param = op->params.find(from + key);
+                if (param != op->params.end()) {
+                    producer->params[to + key] = param->second;
+                }
+            }
+            for (const char* key : {"scale", "shift"}) {
+                auto attr = op->attrs.find(from + key);
+                if (attr != op->attrs.end()) {
+                    producer->attrs[to + key] = attr->second;
+                }
+            }
+        }
+        producer->params["stages"] = pnnx::Parameter(offset + count);
+
+        SIMPLE_LOG_DEBUG("GraphOptimizer merge %s into %s\n", op->name.c_str(),
+                         producer->name.c_str());
+        RemoveIntoProducer(graph, producer, op);
+        ++merged;
+    }
+    return merged;
+}
+} // namespace nn
@@ -0,0 +1,29 @@
+#ifndef SIMPLE_NN_GRAPH_OPTIMIZER_H_
+#define SIMPLE_NN_GRAPH_OPTIMIZER_H_
+
+#include "runtime/pnnx/ir.h"
+
+namespace nn {
+/// @brief rewrites a loaded pnnx graph before layers are created, every removed op is one
+/// less full pass over its activation memory
+///  - batchnorm right after conv/linear is folded into their weight and bias
+///  - relu, leaky_relu and silu right after conv/linear become their kernel epilogue
+///  - the remaining batchnorm and activation ops are lowered to nn.Elementwise and chains
+///    of them are merged into one op
+class GraphOptimizer {
+public:
+    GraphOptimizer()  = default;
+    ~GraphOptimizer() = default;
+
+    /// @return number of ops removed from the graph
+    int Optimize(pnnx::Graph& graph) const;
+
+private:
+    int FoldBatchNorm(pnnx::Graph& graph) const;
+    int FuseActivation(pnnx::Graph& graph) const;
+    void LowerElementwise(pnnx::Graph& graph) const;
+    int MergeElementwise(pnnx::Graph& graph) const;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_GRAPH_OPTIMIZER_H_
@@ -0,0 +1,31 @@
+#include "runtime/kernel/activation.h"
+
+#include <cmath>
+
+namespace nn {
+namespace kernel {
+void ApplyActivation(const Activation& activation, float* data, size_t count) {
+    switch (activation.type) {
+        case ActivationType::M_RELU:
+            for (size_t i = 0; i < count; ++i) {
+                data[i] = data[i] > 0.f ? data[i] : 0.f;
+            }
+            break;
+        case ActivationType::M_LEAKY_RELU: {
+            const float alpha = activation.alpha;
+            for (size_t i = 0; i < count; ++i) {
+                data[i] = data[i] > 0.f ? data[i] : data[i] * alpha;
+            }
+            break;
+        }
+        case ActivationType::M_SILU:
+            for (size_t i = 0; i < count; ++i) {
+                data[i] = data[i] / (1.f + std::exp(-data[i]));
+            }
+            break;
+        default:
+            break;
+    }
+}
+} // namespace kernel
+} // namespace nn
@@ -0,0 +1,29 @@
+#ifndef SIMPLE_NN_KERNEL_ACTIVATION_H_
+#define SIMPLE_NN_KERNEL_ACTIVATION_H_
+
+#include <cstddef>
+
+namespace nn {
+namespace kernel {
+enum class ActivationType {
+    M_NONE,
+    M_RELU,
+    // x for x > 0, alpha * x otherwise
+    M_LEAKY_RELU,
+    // x * sigmoid(x)
+    M_SILU,
+};
+
+/// @brief pointwise activation fused into the epilogue of a kernel, applied while the
+/// output tile is still in cache
+struct Activation {
+    ActivationType type{ActivationType::M_NONE};
+    float alpha{0.f};
+};
+
+/// @brief data[i] = activation(data[i]) for count floats
+void ApplyActivation(const Activation& activation, float* data, size_t count);
+} // namespace kernel
+} // namespace nn
+
+#endif // SIMPLE_NN_KERNEL_ACTIVATION_H_
@@ -0,0 +1,191 @@
+#include "runtime/kernel/conv.h"
+
+#include "runtime/kernel/gemm.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace nn {
+namespace kernel {
+namespace {
+void DepthwiseGeneric(const ConvShape& s, const float* x, const float* w, float bias, float* y) {
+    // no bounds checks inside, which lets the compiler vectorize stride 1 rows
+    auto interior = [&](float* row, int oy, int ox_begin, int ox_end, int ky_begin, int ky_end)
+        -> int {
+        const int iy0 = oy * s.stride_h - s.pad_h;
+        for (int ox = ox_begin; ox < ox_end; ++ox) {
+            row[ox] = bias;
+        }
+        for (int ky = ky_begin; ky < ky_end; ++ky) {
+            const float* src = x + (iy0 + ky * s.dilation_h) * s.in_w - s.pad_w;
+            for (int kx = 0; kx < s.kernel_w; ++kx) {
+                const float wk   = w[ky * s.kernel_w + kx];
+                const float* tap = src + kx * s.dilation_w;
+                for (int ox = ox_begin; ox < ox_end; ++ox) {
+                    row[ox] += wk * tap[ox * s.stride_w];
+                }
+            }
+        }
+        return ox_end;
+    };
+    DepthwiseChannel(s, x, w, bias, y, interior);
+}
+
+DepthwiseKernel SelectDepthwiseKernel(CpuIsa isa) {
+    switch (ResolveCpuIsa(isa)) {
+#ifdef CONFIG_SIMPLE_NN_ENABLE_X86
+        case CpuIsa::M_AVX512_VNNI:
+        case CpuIsa::M_AVX512:
+            return GetDepthwiseKernelAvx512();
+        case CpuIsa::M_AVX2:
+            return GetDepthwiseKernelAvx2();
+#endif
+        default:
+            return &DepthwiseGeneric;
+    }
+}
+
+// rows [k0, k0 + kc) of the im2col matrix of one group, row k is the tap (c, ky, kx) and
+// column n the output pixel (oy, ox)
+void PackIm2col(const ConvShape& s,
+                const float* x,
+                int panel_width,
+                int k0,
+                int kc,
+                int n0,
+                float* dst) {
+    const int taps = s.kernel_h * s.kernel_w;
+    const int N    = s.out_h * s.out_w;
+    for (int kk = 0; kk < kc; ++kk) {
+        const int k      = k0 + kk;
+        const int c      = k / taps;
+        const int ky     = k % taps / s.kernel_w;
+        const int kx     = k % taps % s.kernel_w;
+        const float* src = x + static_cast<size_t>(c) * s.in_h * s.in_w;
+        float* row       = dst + kk * panel_width;
+
+        // a panel spans few output rows, each run within one row has a fixed input row
+        int j = 0;
+        while (j < panel_width) {
+            const int n = n0 + j;
+            if (n >= N) {
+                memset(row + j, 0, (panel_width - j) * sizeof(float));
+                break;
+            }
+            const int oy  = n / s.out_w;
+            const int ox  = n % s.out_w;
+            const int run = std::min(std::min(panel_width - j, s.out_w - ox), N - n);
+            const int iy  = oy * s.stride_h - s.pad_h + ky * s.dilation_h;
+            if (iy < 0 || iy >= s.in_h) {
+                memset(row + j, 0, run * sizeof(float));
+            } else {
+                const float* line = src + iy * s.in_w;
+                const int ix0     = ox * s.stride_w - s.pad_w + kx * s.dilation_w;
+                for (int t = 0; t < run; ++t) {
+                    const int ix = ix0 + t * s.stride_w;
+                    row[j + t]   = ix >= 0 && ix < s.in_w ? line[ix] : 0.f;
+                }
+            }
+            j += run;
+        }
+    }
+}
+
+// 1x1 stride 1 without padding, x[c, h * w] already is the B matrix
+void PackPointwise(const float* x, int N, int panel_width, int k0, int kc, int n0, float* dst) {
+    const int nr = std::min(panel_width, N - n0);
+    for (int kk = 0; kk < kc; ++kk) {
+        float* row = dst + kk * panel_width;
+        memcpy(row, x + static_cast<size_t>(k0 + kk) * N + n0, nr * sizeof(float));
+        if (nr < panel_width) {
+            memset(row + nr, 0, (panel_width - nr) * sizeof(float));
+        }
+    }
+}
+} // namespace
+
+void Conv2dIm2colGemm(const ConvShape& shape,
+                      int in_channels,
+                      int out_channels,
+                      int groups,
+                      const float* x,
+                      const float* weight,
+                      const float* bias,
+                      const Activation& activation,
+                      float* y,
+                      CpuIsa isa,
+                      ThreadPool* pool) {
+    const int in_group    = in_channels / groups;
+    const int out_group   = out_channels / groups;
+    const int M           = out_group;
+    const int N           = shape.out_h * shape.out_w;
+    const int K           = in_group * shape.kernel_h * shape.kernel_w;
+    const int panel_width = GemmPanelWidth(isa);
+    const bool pointwise  = shape.kernel_h == 1 && shape.kernel_w == 1 && shape.stride_h == 1 &&
+                           shape.stride_w == 1 && shape.pad_h == 0 && shape.pad_w == 0;
+
+    for (int g = 0; g < groups; ++g) {
+        const float* xg = x + static_cast<size_t>(g) * in_group * shape.in_h * shape.in_w;
+        GemmPackFn pack;
+        if (pointwise) {
+            pack = [=](int k0, int kc, int n0, float* dst) {
+                PackPointwise(xg, N, panel_width, k0, kc, n0, dst);
+            };
+        } else {
+            pack = [=, &shape](int k0, int kc, int n0, float* dst) {
+                PackIm2col(shape, xg, panel_width, k0, kc, n0, dst);
+            };
+        }
+
+        GemmEpilogue epilogue;
+        epilogue.activation = activation;
+        if (bias) {
+            epilogue.bias      = bias + g * out_group;
+            epilogue.bias_mode = BiasMode::M_ROW;
+        }
+        SgemmPackOnTheFly(M,
+                          N,
+                          K,
+                          weight + static_cast<size_t>(g) * M * K,
+                          K,
+                          pack,
+                          y + static_cast<size_t>(g) * M * N,
+                          N,
+                          epilogue,
+                          isa,
+                          pool);
+    }
+}
+
+void Conv2dDepthwise(const ConvShape& shape,
+                     int channels,
+                     const float* x,
+                     const float* weight,
+                     const float* bias,
+                     const Activation& activation,
+                     float* y,
+                     CpuIsa isa,
+                     ThreadPool* pool) {
+    const DepthwiseKernel kernel = SelectDepthwiseKernel(isa);
+    const size_t in_plane        = static_cast<size_t>(shape.in_h) * shape.in_w;
+    const size_t out_plane       = static_cast<size_t>(shape.out_h) * shape.out_w;
+    const int taps               = shape.kernel_h * shape.kernel_w;
+    auto run_channels            = [&](int64_t begin, int64_t end) {
+        for (int64_t c = begin; c < end; ++c) {
+            kernel(shape,
+                   x + c * in_plane,
+                   weight + c * taps,
+                   bias ? bias[c] : 0.f,
+                   y + c * out_plane);
+            ApplyActivation(activation, y + c * out_plane, out_plane);
+        }
+    };
+
+    if (pool) {
+        pool->ParallelFor(0, channels, run_channels);
+    } else {
+        run_channels(0, channels);
+    }
+}
+} // namespace kernel
+} // namespace nn
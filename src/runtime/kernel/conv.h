@@ -0,0 +1,44 @@
+#ifndef SIMPLE_NN_KERNEL_CONV_H_
+#define SIMPLE_NN_KERNEL_CONV_H_
+
+#include "runtime/cpu.h"
+#include "runtime/kernel/activation.h"
+#include "runtime/kernel/conv_kernel.h"
+#include "runtime/thread_pool.h"
+
+namespace nn {
+namespace kernel {
+/// @brief y[out_channels, out_h, out_w] = conv(x[in_channels, in_h, in_w]) + bias for one image
+/// as one gemm per group, the im2col matrix is never materialized, every gemm worker packs
+/// the block it multiplies straight from x. a 1x1 stride 1 convolution without padding reads
+/// x as the B matrix itself
+/// @param[in] weight [out_channels, in_channels / groups * kernel_h * kernel_w]
+/// @param[in] bias out_channels floats, may be nullptr
+void Conv2dIm2colGemm(const ConvShape& shape,
+                      int in_channels,
+                      int out_channels,
+                      int groups,
+                      const float* x,
+                      const float* weight,
+                      const float* bias,
+                      const Activation& activation,
+                      float* y,
+                      CpuIsa isa,
+                      ThreadPool* pool);
+
+/// @brief depthwise convolution of one image, every channel is convolved with its own filter
+/// @param[in] weight [channels, kernel_h * kernel_w]
+/// @param[in] bias channels floats, may be nullptr
+void Conv2dDepthwise(const ConvShape& shape,
+                     int channels,
+                     const float* x,
+                     const float* weight,
+                     const float* bias,
+                     const Activation& activation,
+                     float* y,
+                     CpuIsa isa,
+                     ThreadPool* pool);
+} // namespace kernel
+} // namespace nn
+
+#endif // SIMPLE_NN_KERNEL_CONV_H_
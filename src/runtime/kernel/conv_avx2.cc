@@ -0,0 +1,39 @@
+#include "runtime/kernel/conv_kernel.h"
+
+#include <immintrin.h>
+
+namespace nn {
+namespace kernel {
+namespace {
+// stride 1 rows are vectorized over 8 consecutive outputs, other strides stay scalar
+void DepthwiseAvx2(const ConvShape& s, const float* x, const float* w, float bias, float* y) {
+    auto interior = [&](float* row, int oy, int ox_begin, int ox_end, int ky_begin, int ky_end)
+        -> int {
+        if (s.stride_w != 1) {
+            return ox_begin;
+        }
+        const int iy0 = oy * s.stride_h - s.pad_h;
+        int ox        = ox_begin;
+        for (; ox + 8 <= ox_end; ox += 8) {
+            __m256 acc = _mm256_set1_ps(bias);
+            for (int ky = ky_begin; ky < ky_end; ++ky) {
+                const float* src = x + (iy0 + ky * s.dilation_h) * s.in_w + ox - s.pad_w;
+                const float* wk  = w + ky * s.kernel_w;
+                for (int kx = 0; kx < s.kernel_w; ++kx) {
+                    acc = _mm256_fmadd_ps(
+                        _mm256_set1_ps(wk[kx]), _mm256_loadu_ps(src + kx * s.dilation_w), acc);
+                }
+            }
+            _mm256_storeu_ps(row + ox, acc);
+        }
+        return ox;
+    };
+    DepthwiseChannel(s, x, w, bias, y, interior);
+}
+} // namespace
+
+DepthwiseKernel GetDepthwiseKernelAvx2() {
+    return &DepthwiseAvx2;
+}
+} // namespace kernel
+} // namespace nn
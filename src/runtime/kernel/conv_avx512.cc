@@ -0,0 +1,39 @@
+#include "runtime/kernel/conv_kernel.h"
+
+#include <immintrin.h>
+
+namespace nn {
+namespace kernel {
+namespace {
+// stride 1 rows are vectorized over 16 consecutive outputs, other strides stay scalar
+void DepthwiseAvx512(const ConvShape& s, const float* x, const float* w, float bias, float* y) {
+    auto interior = [&](float* row, int oy, int ox_begin, int ox_end, int ky_begin, int ky_end)
+        -> int {
+        if (s.stride_w != 1) {
+            return ox_begin;
+        }
+        const int iy0 = oy * s.stride_h - s.pad_h;
+        int ox        = ox_begin;
+        for (; ox + 16 <= ox_end; ox += 16) {
+            __m512 acc = _mm512_set1_ps(bias);
+            for (int ky = ky_begin; ky < ky_end; ++ky) {
+                const float* src = x + (iy0 + ky * s.dilation_h) * s.in_w + ox - s.pad_w;
+                const float* wk  = w + ky * s.kernel_w;
+                for (int kx = 0; kx < s.kernel_w; ++kx) {
+                    acc = _mm512_fmadd_ps(
+                        _mm512_set1_ps(wk[kx]), _mm512_loadu_ps(src + kx * s.dilation_w), acc);
+                }
+            }
+            _mm512_storeu_ps(row + ox, acc);
+        }
+        return ox;
+    };
+    DepthwiseChannel(s, x, w, bias, y, interior);
+}
+} // namespace
+
+DepthwiseKernel GetDepthwiseKernelAvx512() {
+    return &DepthwiseAvx512;
+}
+} // namespace kernel
+} // namespace nn
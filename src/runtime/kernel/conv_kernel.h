@@ -0,0 +1,95 @@
+#ifndef SIMPLE_NN_KERNEL_CONV_KERNEL_H_
+#define SIMPLE_NN_KERNEL_CONV_KERNEL_H_
+
+// shared by the per isa conv translation units, keep it free of inline code with external
+// linkage since those units are built with their own target flags
+
+namespace nn {
+namespace kernel {
+/// @brief geometry of a 2d convolution over one image, pads are applied on both sides
+struct ConvShape {
+    int in_h;
+    int in_w;
+    int out_h;
+    int out_w;
+    int kernel_h;
+    int kernel_w;
+    int stride_h;
+    int stride_w;
+    int pad_h;
+    int pad_w;
+    int dilation_h;
+    int dilation_w;
+};
+
+/// @brief y[out_h, out_w] = x[in_h, in_w] * w[kernel_h, kernel_w] + bias for one channel
+typedef void (*DepthwiseKernel)(const ConvShape& shape,
+                                const float* x,
+                                const float* w,
+                                float bias,
+                                float* y);
+
+/// @brief walk one depthwise channel, border outputs are computed here with bounds checks.
+/// every output row hands [ox_begin, ox_end), where all taps are inside the row, to
+/// interior(row, oy, ox_begin, ox_end, ky_begin, ky_end), which returns the first ox it left
+/// undone
+template <typename Interior>
+static inline void DepthwiseChannel(const ConvShape& s,
+                                    const float* x,
+                                    const float* w,
+                                    float bias,
+                                    float* y,
+                                    const Interior& interior) {
+    // first and one past last ox whose leftmost and rightmost taps are inside the row
+    int ox_begin = (s.pad_w + s.stride_w - 1) / s.stride_w;
+    int ox_end   = 0;
+    if (s.in_w + s.pad_w - (s.kernel_w - 1) * s.dilation_w > 0) {
+        ox_end = (s.in_w + s.pad_w - (s.kernel_w - 1) * s.dilation_w - 1) / s.stride_w + 1;
+    }
+    ox_begin = ox_begin < s.out_w ? ox_begin : s.out_w;
+    ox_end   = ox_end < s.out_w ? ox_end : s.out_w;
+    ox_end   = ox_end > ox_begin ? ox_end : ox_begin;
+
+    for (int oy = 0; oy < s.out_h; ++oy) {
+        const int iy0 = oy * s.stride_h - s.pad_h;
+        int ky_begin  = 0;
+        int ky_end    = s.kernel_h;
+        while (ky_begin < ky_end && iy0 + ky_begin * s.dilation_h < 0) {
+            ++ky_begin;
+        }
+        while (ky_end > ky_begin && iy0 + (ky_end - 1) * s.dilation_h >= s.in_h) {
+            --ky_end;
+        }
+
+        float* row = y + oy * s.out_w;
+        auto point = [&](int ox) {
+            const int ix0 = ox * s.stride_w - s.pad_w;
+            float sum     = bias;
+            for (int ky = ky_begin; ky < ky_end; ++ky) {
+                const float* src = x + (iy0 + ky * s.dilation_h) * s.in_w;
+                for (int kx = 0; kx < s.kernel_w; ++kx) {
+                    const int ix = ix0 + kx * s.dilation_w;
+                    if (ix >= 0 && ix < s.in_w) {
+                        sum += src[ix] * w[ky * s.kernel_w + kx];
+                    }
+                }
+            }
+            row[ox] = sum;
+        };
+
+        for (int ox = 0; ox < ox_begin; ++ox) {
+            point(ox);
+        }
+        const int rest = interior(row, oy, ox_begin, ox_end, ky_begin, ky_end);
+        for (int ox = rest; ox < s.out_w; ++ox) {
+            point(ox);
+        }
+    }
+}
+
+DepthwiseKernel GetDepthwiseKernelAvx2();
+DepthwiseKernel GetDepthwiseKernelAvx512();
+} // namespace kernel
+} // namespace nn
+
+#endif // SIMPLE_NN_KERNEL_CONV_KERNEL_H_
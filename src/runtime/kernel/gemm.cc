@@ -0,0 +1,234 @@
+#include "runtime/kernel/gemm.h"
+
+#include "runtime/kernel/gemm_kernel.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace nn {
+namespace kernel {
+namespace {
+// depth of one K block, a packed B block of GEMM_KC rows stays in L1 while it is
+// multiplied with every row tile of A
+constexpr int GEMM_KC = 256;
+
+constexpr int GENERIC_MR = 4;
+constexpr int GENERIC_NR = 8;
+
+// portable tile, the fixed trip counts let the compiler vectorize the inner loop
+template <int ROWS>
+struct GenericTile {
+    static void Run(int K,
+                    const float* a,
+                    int lda,
+                    const float* b,
+                    float* c,
+                    int ldc,
+                    const float* col_bias,
+                    const float* row_bias,
+                    bool accumulate) {
+        float acc[ROWS][GENERIC_NR];
+        for (int r = 0; r < ROWS; ++r) {
+            for (int j = 0; j < GENERIC_NR; ++j) {
+                if (accumulate) {
+                    acc[r][j] = c[r * ldc + j];
+                } else {
+                    acc[r][j] = (col_bias ? col_bias[j] : 0.f) + (row_bias ? row_bias[r] : 0.f);
+                }
+            }
+        }
+        for (int k = 0; k < K; ++k) {
+            for (int r = 0; r < ROWS; ++r) {
+                const float av = a[r * lda + k];
+                for (int j = 0; j < GENERIC_NR; ++j) {
+                    acc[r][j] += av * b[j];
+                }
+            }
+            b += GENERIC_NR;
+        }
+        for (int r = 0; r < ROWS; ++r) {
+            memcpy(c + r * ldc, acc[r], GENERIC_NR * sizeof(float));
+        }
+    }
+};
+
+// level of the micro kernel an isa runs, SelectGemmKernel maps every level it merges alike
+CpuIsa GemmKernelLevel(CpuIsa isa) {
+    return isa == CpuIsa::M_AVX512_VNNI ? CpuIsa::M_AVX512 : isa;
+}
+
+GemmKernel SelectGemmKernel(CpuIsa isa) {
+    switch (ResolveCpuIsa(isa)) {
+#ifdef CONFIG_SIMPLE_NN_ENABLE_X86
+        case CpuIsa::M_AVX512_VNNI:
+        case CpuIsa::M_AVX512:
+            return GetGemmKernelAvx512();
+        case CpuIsa::M_AVX2:
+            return GetGemmKernelAvx2();
+        case CpuIsa::M_SSE42:
+            return GetGemmKernelSse42();
+#endif
+        default: {
+            GemmKernel kernel;
+            kernel.mr    = GENERIC_MR;
+            kernel.nr    = GENERIC_NR;
+            kernel.micro = &GemmRowDispatch<GenericTile, GENERIC_MR>::Run;
+            return kernel;
+        }
+    }
+}
+
+// block(p, k0, kc, buffer) returns rows [k0, k0 + kc) of packed panel p, either in place or
+// written to buffer which holds GEMM_KC x GEMM_MAX_NR floats
+template <typename BlockFn>
+void SgemmDriver(const GemmKernel& kernel,
+                 int M,
+                 int N,
+                 int K,
+                 const float* a,
+                 int lda,
+                 const BlockFn& block,
+                 float* c,
+                 int ldc,
+                 const GemmEpilogue& epilogue,
+                 ThreadPool* pool) {
+    const int tile_rows   = kernel.mr;
+    const int panel_width = kernel.nr;
+    const int panels      = (N + panel_width - 1) / panel_width;
+    const bool activate   = epilogue.activation.type != ActivationType::M_NONE;
+    auto run_panels       = [&](int64_t begin, int64_t end) {
+        alignas(64) float tile[GEMM_MAX_MR * GEMM_MAX_NR];
+        alignas(64) float bias_pad[GEMM_MAX_NR];
+        alignas(64) float buffer[GEMM_KC * GEMM_MAX_NR];
+        for (int64_t p = begin; p < end; ++p) {
+            const int j  = static_cast<int>(p) * panel_width;
+            const int nr = std::min(panel_width, N - j);
+
+            const float* col_bias = nullptr;
+            if (epilogue.bias_mode == BiasMode::M_COL && epilogue.bias) {
+                col_bias = epilogue.bias + j;
+                if (nr < panel_width) {
+                    memset(bias_pad, 0, panel_width * sizeof(float));
+                    memcpy(bias_pad, col_bias, nr * sizeof(float));
+                    col_bias = bias_pad;
+                }
+            }
+
+            for (int k0 = 0; k0 < K; k0 += GEMM_KC) {
+                const int kc          = std::min(GEMM_KC, K - k0);
+                const bool accumulate = k0 > 0;
+                const float* bp       = block(static_cast<int>(p), k0, kc, buffer);
+                for (int i = 0; i < M; i += tile_rows) {
+                    const int mr          = std::min(tile_rows, M - i);
+                    const float* row_bias = nullptr;
+                    if (epilogue.bias_mode == BiasMode::M_ROW && epilogue.bias) {
+                        row_bias = epilogue.bias + i;
+                    }
+                    const float* ap = a + static_cast<size_t>(i) * lda + k0;
+                    float* cp       = c + static_cast<size_t>(i) * ldc + j;
+                    if (nr == panel_width) {
+                        kernel.micro(mr, kc, ap, lda, bp, cp, ldc, col_bias, row_bias, accumulate);
+                    } else {
+                        // ragged last panel goes through a full width tile
+                        if (accumulate) {
+                            for (int r = 0; r < mr; ++r) {
+                                memcpy(tile + r * panel_width, cp + r * ldc, nr * sizeof(float));
+                            }
+                        }
+                        kernel.micro(
+                            mr, kc, ap, lda, bp, tile, panel_width, col_bias, row_bias, accumulate);
+                        for (int r = 0; r < mr; ++r) {
+                            memcpy(cp + r * ldc, tile + r * panel_width, nr * sizeof(float));
+                        }
+                    }
+
+                    if (activate && k0 + kc == K) {
+                        for (int r = 0; r < mr; ++r) {
+                            ApplyActivation(epilogue.activation, cp + r * ldc, nr);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    if (pool) {
+        pool->ParallelFor(0, panels, run_panels);
+    } else {
+        run_panels(0, panels);
+    }
+}
+} // namespace
+
+int GemmPanelWidth(CpuIsa isa) {
+    return SelectGemmKernel(isa).nr;
+}
+
+bool GemmPackedCompatible(CpuIsa packed, CpuIsa isa) {
+    // not resolved against the host, a level it can not run never matches the one it runs
+    return GemmKernelLevel(packed) == GemmKernelLevel(isa);
+}
+
+size_t GemmPackedBSize(int K, int N, CpuIsa isa) {
+    const int panel_width = GemmPanelWidth(isa);
+    return static_cast<size_t>((N + panel_width - 1) / panel_width) * panel_width * K;
+}
+
+void GemmPackB(const float* b, int K, int N, int ldb, bool transposed, float* packed, CpuIsa isa) {
+    const int panel_width = GemmPanelWidth(isa);
+    const int panels      = (N + panel_width - 1) / panel_width;
+    for (int p = 0; p < panels; ++p) {
+        float* dst = packed + static_cast<size_t>(p) * K * panel_width;
+        for (int k = 0; k < K; ++k) {
+            for (int j = 0; j < panel_width; ++j) {
+                const int n = p * panel_width + j;
+                if (n >= N) {
+                    dst[k * panel_width + j] = 0.f;
+                } else if (transposed) {
+                    dst[k * panel_width + j] = b[static_cast<size_t>(n) * ldb + k];
+                } else {
+                    dst[k * panel_width + j] = b[static_cast<size_t>(k) * ldb + n];
+                }
+            }
+        }
+    }
+}
+
+void SgemmPackedB(int M,
+                  int N,
+                  int K,
+                  const float* a,
+                  int lda,
+                  const float* packed_b,
+                  float* c,
+                  int ldc,
+                  const GemmEpilogue& epilogue,
+                  CpuIsa isa,
+                  ThreadPool* pool) {
+    const int panel_width = GemmPanelWidth(isa);
+    auto block            = [&](int p, int k0, int, float*) -> const float* {
+        return packed_b + (static_cast<size_t>(p) * K + k0) * panel_width;
+    };
+    SgemmDriver(SelectGemmKernel(isa), M, N, K, a, lda, block, c, ldc, epilogue, pool);
+}
+
+void SgemmPackOnTheFly(int M,
+                       int N,
+                       int K,
+                       const float* a,
+                       int lda,
+                       const GemmPackFn& pack,
+                       float* c,
+                       int ldc,
+                       const GemmEpilogue& epilogue,
+                       CpuIsa isa,
+                       ThreadPool* pool) {
+    const int panel_width = GemmPanelWidth(isa);
+    auto block            = [&](int p, int k0, int kc, float* buffer) -> const float* {
+        pack(k0, kc, p * panel_width, buffer);
+        return buffer;
+    };
+    SgemmDriver(SelectGemmKernel(isa), M, N, K, a, lda, block, c, ldc, epilogue, pool);
+}
+} // namespace kernel
+} // namespace nn
@@ -0,0 +1,85 @@
+#ifndef SIMPLE_NN_KERNEL_GEMM_H_
+#define SIMPLE_NN_KERNEL_GEMM_H_
+
+#include "runtime/cpu.h"
+#include "runtime/kernel/activation.h"
+#include "runtime/thread_pool.h"
+
+#include <cstddef>
+#include <functional>
+
+namespace nn {
+namespace kernel {
+enum class BiasMode {
+    M_NONE,
+    // one bias per row of C
+    M_ROW,
+    // one bias per column of C
+    M_COL,
+};
+
+struct GemmEpilogue {
+    const float* bias{nullptr};
+    BiasMode bias_mode{BiasMode::M_NONE};
+    // applied to every C tile once its last K block is done
+    Activation activation{};
+};
+
+// every function takes the cpu level of its kernel, B must be packed for the same level
+// it is multiplied with since the panel width differs between levels
+
+/// @brief column count of one packed B panel, the register tile width of the micro kernel
+int GemmPanelWidth(CpuIsa isa);
+
+/// @brief whether B packed for one level runs with the kernels of the other, levels sharing a
+/// micro kernel share its panel layout, avx512 vnni runs the avx512 one
+bool GemmPackedCompatible(CpuIsa packed, CpuIsa isa);
+
+/// @brief floats needed by PackB for a K x N operand
+size_t GemmPackedBSize(int K, int N, CpuIsa isa);
+
+/// @brief repack B into column panels of GemmPanelWidth(), each panel stores K rows of
+/// panel width floats contiguously and the last panel is zero padded
+/// @param[in] b source, B[k][n] = b[k * ldb + n] or b[n * ldb + k] when transposed
+/// @param[out] packed GemmPackedBSize() floats aligned to MEMORY_ALIGNMENT (64 bytes), the
+/// kernels use aligned loads on the panels so e.g. std::vector storage faults, use an
+/// AlignedBuffer
+void GemmPackB(const float* b, int K, int N, int ldb, bool transposed, float* packed, CpuIsa isa);
+
+/// @brief C[M, N] = A[M, K] * B[K, N] + bias with B packed by GemmPackB
+/// @param[in] packed_b output of GemmPackB, 64-byte aligned like it
+/// @param[in] pool splits the work over column panels, may be nullptr
+void SgemmPackedB(int M,
+                  int N,
+                  int K,
+                  const float* a,
+                  int lda,
+                  const float* packed_b,
+                  float* c,
+                  int ldc,
+                  const GemmEpilogue& epilogue,
+                  CpuIsa isa,
+                  ThreadPool* pool);
+
+/// @brief write rows [k0, k0 + kc) of the B columns [n0, n0 + GemmPanelWidth()) to dst in
+/// packed panel layout, columns past N must be written as zero
+using GemmPackFn = std::function<void(int k0, int kc, int n0, float* dst)>;
+
+/// @brief C[M, N] = A[M, K] * B[K, N] + bias where B is never materialized, every worker
+/// packs the block it is about to multiply through pack, e.g. straight from an image for
+/// im2col convolution. a block is at most 256 rows so it stays in cache with its tile of C
+void SgemmPackOnTheFly(int M,
+                       int N,
+                       int K,
+                       const float* a,
+                       int lda,
+                       const GemmPackFn& pack,
+                       float* c,
+                       int ldc,
+                       const GemmEpilogue& epilogue,
+                       CpuIsa isa,
+                       ThreadPool* pool);
+} // namespace kernel
+} // namespace nn
+
+#endif // SIMPLE_NN_KERNEL_GEMM_H_
@@ -0,0 +1,65 @@
+#include "runtime/kernel/gemm_kernel.h"
+
+#include <immintrin.h>
+
+namespace nn {
+namespace kernel {
+namespace {
+constexpr int MR = 6;
+constexpr int NR = 16;
+
+// C[ROWS, 16] (+)= A[ROWS, K] * Bpanel[K, 16], 12 ymm accumulators
+template <int ROWS>
+struct Avx2Tile {
+    static void Run(int K,
+                    const float* a,
+                    int lda,
+                    const float* b,
+                    float* c,
+                    int ldc,
+                    const float* col_bias,
+                    const float* row_bias,
+                    bool accumulate) {
+        __m256 acc0[ROWS];
+        __m256 acc1[ROWS];
+        for (int r = 0; r < ROWS; ++r) {
+            if (accumulate) {
+                acc0[r] = _mm256_loadu_ps(c + r * ldc);
+                acc1[r] = _mm256_loadu_ps(c + r * ldc + 8);
+            } else {
+                acc0[r] = col_bias ? _mm256_loadu_ps(col_bias) : _mm256_setzero_ps();
+                acc1[r] = col_bias ? _mm256_loadu_ps(col_bias + 8) : _mm256_setzero_ps();
+                if (row_bias) {
+                    __m256 rb = _mm256_set1_ps(row_bias[r]);
+                    acc0[r]   = _mm256_add_ps(acc0[r], rb);
+                    acc1[r]   = _mm256_add_ps(acc1[r], rb);
+                }
+            }
+        }
+        for (int k = 0; k < K; ++k) {
+            __m256 b0 = _mm256_load_ps(b);
+            __m256 b1 = _mm256_load_ps(b + 8);
+            b += NR;
+            for (int r = 0; r < ROWS; ++r) {
+                __m256 av = _mm256_broadcast_ss(a + r * lda + k);
+                acc0[r]   = _mm256_fmadd_ps(av, b0, acc0[r]);
+                acc1[r]   = _mm256_fmadd_ps(av, b1, acc1[r]);
+            }
+        }
+        for (int r = 0; r < ROWS; ++r) {
+            _mm256_storeu_ps(c + r * ldc, acc0[r]);
+            _mm256_storeu_ps(c + r * ldc + 8, acc1[r]);
+        }
+    }
+};
+} // namespace
+
+GemmKernel GetGemmKernelAvx2() {
+    GemmKernel kernel;
+    kernel.mr    = MR;
+    kernel.nr    = NR;
+    kernel.micro = &GemmRowDispatch<Avx2Tile, MR>::Run;
+    return kernel;
+}
+} // namespace kernel
+} // namespace nn
@@ -0,0 +1,65 @@
+#include "runtime/kernel/gemm_kernel.h"
+
+#include <immintrin.h>
+
+namespace nn {
+namespace kernel {
+namespace {
+constexpr int MR = 6;
+constexpr int NR = 32;
+
+// C[ROWS, 32] (+)= A[ROWS, K] * Bpanel[K, 32], 12 zmm accumulators
+template <int ROWS>
+struct Avx512Tile {
+    static void Run(int K,
+                    const float* a,
+                    int lda,
+                    const float* b,
+                    float* c,
+                    int ldc,
+                    const float* col_bias,
+                    const float* row_bias,
+                    bool accumulate) {
+        __m512 acc0[ROWS];
+        __m512 acc1[ROWS];
+        for (int r = 0; r < ROWS; ++r) {
+            if (accumulate) {
+                acc0[r] = _mm512_loadu_ps(c + r * ldc);
+                acc1[r] = _mm512_loadu_ps(c + r * ldc + 16);
+            } else {
+                acc0[r] = col_bias ? _mm512_loadu_ps(col_bias) : _mm512_setzero_ps();
+                acc1[r] = col_bias ? _mm512_loadu_ps(col_bias + 16) : _mm512_setzero_ps();
+                if (row_bias) {
+                    __m512 rb = _mm512_set1_ps(row_bias[r]);
+                    acc0[r]   = _mm512_add_ps(acc0[r], rb);
+                    acc1[r]   = _mm512_add_ps(acc1[r], rb);
+                }
+            }
+        }
+        for (int k = 0; k < K; ++k) {
+            __m512 b0 = _mm512_load_ps(b);
+            __m512 b1 = _mm512_load_ps(b + 16);
+            b += NR;
+            for (int r = 0; r < ROWS; ++r) {
+                __m512 av = _mm512_set1_ps(a[r * lda + k]);
+                acc0[r]   = _mm512_fmadd_ps(av, b0, acc0[r]);
+                acc1[r]   = _mm512_fmadd_ps(av, b1, acc1[r]);
+            }
+        }
+        for (int r = 0; r < ROWS; ++r) {
+            _mm512_storeu_ps(c + r * ldc, acc0[r]);
+            _mm512_storeu_ps(c + r * ldc + 16, acc1[r]);
+        }
+    }
+};
+} // namespace
+
+GemmKernel GetGemmKernelAvx512() {
+    GemmKernel kernel;
+    kernel.mr    = MR;
+    kernel.nr    = NR;
+    kernel.micro = &GemmRowDispatch<Avx512Tile, MR>::Run;
+    return kernel;
+}
+} // namespace kernel
+} // namespace nn
@@ -0,0 +1,74 @@
+#ifndef SIMPLE_NN_KERNEL_GEMM_KERNEL_H_
+#define SIMPLE_NN_KERNEL_GEMM_KERNEL_H_
+
+// shared by the per isa gemm translation units, those are built with their own target flags
+// so this header must stay free of inline code with external linkage
+
+namespace nn {
+namespace kernel {
+// largest register tile of any micro kernel, sizes the edge tile buffers of the driver
+constexpr int GEMM_MAX_MR = 6;
+constexpr int GEMM_MAX_NR = 32;
+
+/// @brief C[rows, nr] (+)= A[rows, K] * Bpanel[K, nr], rows <= mr. without accumulate C is
+/// initialized from col_bias (nr floats) and row_bias (rows floats) when they are set
+typedef void (*GemmMicroKernel)(int rows,
+                                int K,
+                                const float* a,
+                                int lda,
+                                const float* b,
+                                float* c,
+                                int ldc,
+                                const float* col_bias,
+                                const float* row_bias,
+                                bool accumulate);
+
+struct GemmKernel {
+    int mr;
+    int nr;
+    GemmMicroKernel micro;
+};
+
+/// @brief dispatch a runtime row count to Tile<ROWS>::Run, ROWS counts down to 1
+template <template <int> class Tile, int ROWS>
+struct GemmRowDispatch {
+    static void Run(int rows,
+                    int K,
+                    const float* a,
+                    int lda,
+                    const float* b,
+                    float* c,
+                    int ldc,
+                    const float* col_bias,
+                    const float* row_bias,
+                    bool accumulate) {
+        if (rows == ROWS) {
+            Tile<ROWS>::Run(K, a, lda, b, c, ldc, col_bias, row_bias, accumulate);
+        } else {
+            GemmRowDispatch<Tile, ROWS - 1>::Run(
+                rows, K, a, lda, b, c, ldc, col_bias, row_bias, accumulate);
+        }
+    }
+};
+
+template <template <int> class Tile>
+struct GemmRowDispatch<Tile, 0> {
+    static void Run(int,
+                    int,
+                    const float*,
+                    int,
+                    const float*,
+                    float*,
+                    int,
+                    const float*,
+                    const float*,
+                    bool) {}
+};
+
+GemmKernel GetGemmKernelSse42();
+GemmKernel GetGemmKernelAvx2();
+GemmKernel GetGemmKernelAvx512();
+} // namespace kernel
+} // namespace nn
+
+#endif // SIMPLE_NN_KERNEL_GEMM_KERNEL_H_
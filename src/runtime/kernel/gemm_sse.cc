@@ -0,0 +1,65 @@
+#include "runtime/kernel/gemm_kernel.h"
+
+#include <immintrin.h>
+
+namespace nn {
+namespace kernel {
+namespace {
+constexpr int MR = 6;
+constexpr int NR = 8;
+
+// C[ROWS, 8] (+)= A[ROWS, K] * Bpanel[K, 8], 12 xmm accumulators, no fma before avx2
+template <int ROWS>
+struct Sse42Tile {
+    static void Run(int K,
+                    const float* a,
+                    int lda,
+                    const float* b,
+                    float* c,
+                    int ldc,
+                    const float* col_bias,
+                    const float* row_bias,
+                    bool accumulate) {
+        __m128 acc0[ROWS];
+        __m128 acc1[ROWS];
+        for (int r = 0; r < ROWS; ++r) {
+            if (accumulate) {
+                acc0[r] = _mm_loadu_ps(c + r * ldc);
+                acc1[r] = _mm_loadu_ps(c + r * ldc + 4);
+            } else {
+                acc0[r] = col_bias ? _mm_loadu_ps(col_bias) : _mm_setzero_ps();
+                acc1[r] = col_bias ? _mm_loadu_ps(col_bias + 4) : _mm_setzero_ps();
+                if (row_bias) {
+                    __m128 rb = _mm_set1_ps(row_bias[r]);
+                    acc0[r]   = _mm_add_ps(acc0[r], rb);
+                    acc1[r]   = _mm_add_ps(acc1[r], rb);
+                }
+            }
+        }
+        for (int k = 0; k < K; ++k) {
+            __m128 b0 = _mm_load_ps(b);
+            __m128 b1 = _mm_load_ps(b + 4);
+            b += NR;
+            for (int r = 0; r < ROWS; ++r) {
+                __m128 av = _mm_set1_ps(a[r * lda + k]);
+                acc0[r]   = _mm_add_ps(acc0[r], _mm_mul_ps(av, b0));
+                acc1[r]   = _mm_add_ps(acc1[r], _mm_mul_ps(av, b1));
+            }
+        }
+        for (int r = 0; r < ROWS; ++r) {
+            _mm_storeu_ps(c + r * ldc, acc0[r]);
+            _mm_storeu_ps(c + r * ldc + 4, acc1[r]);
+        }
+    }
+};
+} // namespace
+
+GemmKernel GetGemmKernelSse42() {
+    GemmKernel kernel;
+    kernel.mr    = MR;
+    kernel.nr    = NR;
+    kernel.micro = &GemmRowDispatch<Sse42Tile, MR>::Run;
+    return kernel;
+}
+} // namespace kernel
+} // namespace nn
@@ -0,0 +1,280 @@
+#include "runtime/kernel/winograd.h"
+
+#include "runtime/kernel/gemm.h"
+#include "runtime/kernel/gemm_kernel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace nn {
+namespace kernel {
+namespace {
+constexpr int TILE_IN  = 6;
+constexpr int TILE_OUT = 4;
+constexpr int TILE_POS = TILE_IN * TILE_IN;
+
+// G of F(4x4, 3x3), u = G g for one filter column
+void TransformWeightVector(const float* g, int stride, float* u, int ostride) {
+    const float g0 = g[0];
+    const float g1 = g[stride];
+    const float g2 = g[2 * stride];
+    u[0]           = g0 / 4.f;
+    u[ostride]     = -(g0 + g1 + g2) / 6.f;
+    u[2 * ostride] = -(g0 - g1 + g2) / 6.f;
+    u[3 * ostride] = g0 / 24.f + g1 / 12.f + g2 / 6.f;
+    u[4 * ostride] = g0 / 24.f - g1 / 12.f + g2 / 6.f;
+    u[5 * ostride] = g2;
+}
+
+// B^T of F(4x4, 3x3), v = B^T d on n tiles at once, row k of the column is d + k * stride
+void TransformInput(const float* d, size_t stride, float* v, size_t ostride, int n) {
+    for (int t = 0; t < n; ++t) {
+        const float d0     = d[t];
+        const float d1     = d[stride + t];
+        const float d2     = d[2 * stride + t];
+        const float d3     = d[3 * stride + t];
+        const float d4     = d[4 * stride + t];
+        const float d5     = d[5 * stride + t];
+        v[t]               = 4.f * d0 - 5.f * d2 + d4;
+        v[ostride + t]     = -4.f * (d1 + d2) + d3 + d4;
+        v[2 * ostride + t] = 4.f * (d1 - d2) - d3 + d4;
+        v[3 * ostride + t] = 2.f * (d3 - d1) - d2 + d4;
+        v[4 * ostride + t] = 2.f * (d1 - d3) - d2 + d4;
+        v[5 * ostride + t] = 4.f * d1 - 5.f * d3 + d5;
+    }
+}
+
+// A^T of F(4x4, 3x3), o = A^T m on n tiles at once
+void TransformOutput(const float* m, size_t stride, float* o, size_t ostride, int n) {
+    for (int t = 0; t < n; ++t) {
+        const float m0     = m[t];
+        const float m1     = m[stride + t];
+        const float m2     = m[2 * stride + t];
+        const float m3     = m[3 * stride + t];
+        const float m4     = m[4 * stride + t];
+        const float m5     = m[5 * stride + t];
+        const float s12    = m1 + m2;
+        const float d12    = m1 - m2;
+        const float s34    = m3 + m4;
+        const float d34    = m3 - m4;
+        o[t]               = m0 + s12 + s34;
+        o[ostride + t]     = d12 + 2.f * d34;
+        o[2 * ostride + t] = s12 + 4.f * s34;
+        o[3 * ostride + t] = d12 + 8.f * d34 + m5;
+    }
+}
+
+// d[TILE_POS][block] = the 6x6 input windows of tiles [t0, t0 + count) of one channel, the
+// lanes past count are zero
+void GatherInput(const ConvShape& s,
+                 const float* src,
+                 int tiles_w,
+                 int t0,
+                 int count,
+                 int block,
+                 float* d) {
+    for (int t = 0; t < block; ++t) {
+        if (t >= count) {
+            for (int p = 0; p < TILE_POS; ++p) {
+                d[p * block + t] = 0.f;
+            }
+            continue;
+        }
+        const int iy0       = (t0 + t) / tiles_w * TILE_OUT - s.pad_h;
+        const int ix0       = (t0 + t) % tiles_w * TILE_OUT - s.pad_w;
+        const bool interior = iy0 >= 0 && iy0 + TILE_IN <= s.in_h && ix0 >= 0 &&
+                              ix0 + TILE_IN <= s.in_w;
+        for (int r = 0; r < TILE_IN; ++r) {
+            const int iy      = iy0 + r;
+            const float* line = src + static_cast<ptrdiff_t>(iy) * s.in_w;
+            float* dst        = d + r * TILE_IN * block + t;
+            for (int col = 0; col < TILE_IN; ++col) {
+                const int ix = ix0 + col;
+                if (interior || (iy >= 0 && iy < s.in_h && ix >= 0 && ix < s.in_w)) {
+                    dst[col * block] = line[ix];
+                } else {
+                    dst[col * block] = 0.f;
+                }
+            }
+        }
+    }
+}
+} // namespace
+
+bool Conv3x3WinogradProfitable(int in_channels, int out_channels, CpuIsa isa) {
+    if (in_channels < 8 || out_channels < 8) {
+        return false;
+    }
+    // flops per 4x4 output tile, transforming a tile is about 264 flops per input channel and
+    // 150 per output channel. the transforms are not built for the wider isas, so a transform
+    // flop costs more gemm flops the wider the gemm kernel is
+    const double ci             = in_channels;
+    const double co             = out_channels;
+    const double transform_cost = GemmPanelWidth(isa) / 4.0;
+    const double direct         = 2.0 * 9 * TILE_OUT * TILE_OUT * ci * co;
+    const double wino = 2.0 * TILE_POS * ci * co + transform_cost * (264 * ci + 150 * co);
+    return wino < 0.75 * direct;
+}
+
+size_t Conv3x3WinogradWeightSize(int in_channels, int out_channels) {
+    return static_cast<size_t>(TILE_POS) * out_channels * in_channels;
+}
+
+void Conv3x3WinogradTransformWeight(const float* weight,
+                                    int in_channels,
+                                    int out_channels,
+                                    float* transformed) {
+    const size_t plane = static_cast<size_t>(out_channels) * in_channels;
+    for (int o = 0; o < out_channels; ++o) {
+        for (int i = 0; i < in_channels; ++i) {
+            const float* g = weight + (static_cast<size_t>(o) * in_channels + i) * 9;
+            float tmp[TILE_IN * 3];
+            float u[TILE_POS];
+            for (int col = 0; col < 3; ++col) {
+                TransformWeightVector(g + col, 3, tmp + col, 3);
+            }
+            for (int row = 0; row < TILE_IN; ++row) {
+                TransformWeightVector(tmp + row * 3, 1, u + row * TILE_IN, 1);
+            }
+            for (int p = 0; p < TILE_POS; ++p) {
+                transformed[p * plane + static_cast<size_t>(o) * in_channels + i] = u[p];
+            }
+        }
+    }
+}
+
+size_t Conv3x3WinogradScratchSize(int in_channels, int out_channels, CpuIsa isa) {
+    // v of the inputs and m of the products, a panel wide at every tile position
+    const size_t block = static_cast<size_t>(GemmPanelWidth(isa));
+    return (static_cast<size_t>(in_channels) + out_channels) * block * TILE_POS * sizeof(float);
+}
+
+bool Conv3x3Winograd(const ConvShape& shape,
+                     int in_channels,
+                     int out_channels,
+                     const float* x,
+                     const float* transformed,
+                     const float* bias,
+                     const Activation& activation,
+                     float* y,
+                     CpuIsa isa,
+                     ScratchPool& scratch,
+                     ThreadPool* pool) {
+    if (scratch.GetSlotSize() < Conv3x3WinogradScratchSize(in_channels, out_channels, isa)) {
+        return false;
+    }
+    const int tiles_h     = (shape.out_h + TILE_OUT - 1) / TILE_OUT;
+    const int tiles_w     = (shape.out_w + TILE_OUT - 1) / TILE_OUT;
+    const int tiles       = tiles_h * tiles_w;
+    const size_t in_plane = static_cast<size_t>(shape.in_h) * shape.in_w;
+    const size_t plane    = static_cast<size_t>(out_channels) * in_channels;
+
+    // a block of tiles is exactly one packed gemm panel, so the transformed inputs of every
+    // tile position are the B operand as they are written
+    const int block       = GemmPanelWidth(isa);
+    const int blocks      = (tiles + block - 1) / block;
+    const size_t v_stride = static_cast<size_t>(in_channels) * block;
+    const size_t m_stride = static_cast<size_t>(out_channels) * block;
+
+    std::atomic<bool> failed(false);
+    auto run_blocks = [&](int64_t begin, int64_t end) {
+        uint8_t* slot = scratch.Acquire();
+        if (!slot) {
+            failed.store(true);
+            return;
+        }
+        // d holds the input windows and later the output tiles of one channel
+        alignas(64) float d[TILE_POS * GEMM_MAX_NR];
+        alignas(64) float tmp[TILE_POS * GEMM_MAX_NR];
+        float* v = reinterpret_cast<float*>(slot);
+        float* m = v + v_stride * TILE_POS;
+        for (int64_t b = begin; b < end; ++b) {
+            const int t0    = static_cast<int>(b) * block;
+            const int count = std::min(block, tiles - t0);
+
+            // the column pass goes through tmp, the row pass writes the gemm B panels
+            for (int c = 0; c < in_channels; ++c) {
+                GatherInput(shape, x + c * in_plane, tiles_w, t0, count, block, d);
+                for (int col = 0; col < TILE_IN; ++col) {
+                    TransformInput(d + col * block,
+                                   TILE_IN * block,
+                                   tmp + col * block,
+                                   TILE_IN * block,
+                                   block);
+                }
+                for (int r = 0; r < TILE_IN; ++r) {
+                    TransformInput(tmp + r * TILE_IN * block,
+                                   block,
+                                   v + r * TILE_IN * v_stride + static_cast<size_t>(c) * block,
+                                   v_stride,
+                                   block);
+                }
+            }
+
+            GemmEpilogue epilogue;
+            for (int p = 0; p < TILE_POS; ++p) {
+                SgemmPackedB(out_channels,
+                             block,
+                             in_channels,
+                             transformed + p * plane,
+                             in_channels,
+                             v + p * v_stride,
+                             m + p * m_stride,
+                             block,
+                             epilogue,
+                             isa,
+                             nullptr);
+            }
+
+            for (int c = 0; c < out_channels; ++c) {
+                const float* src = m + static_cast<size_t>(c) * block;
+                for (int col = 0; col < TILE_IN; ++col) {
+                    TransformOutput(src + col * m_stride,
+                                    TILE_IN * m_stride,
+                                    tmp + col * block,
+                                    TILE_IN * block,
+                                    block);
+                }
+                for (int r = 0; r < TILE_OUT; ++r) {
+                    TransformOutput(tmp + r * TILE_IN * block,
+                                    block,
+                                    d + r * TILE_OUT * block,
+                                    block,
+                                    block);
+                }
+
+                if (bias) {
+                    for (int i = 0; i < TILE_OUT * TILE_OUT * block; ++i) {
+                        d[i] += bias[c];
+                    }
+                }
+                ApplyActivation(activation, d, TILE_OUT * TILE_OUT * block);
+
+                float* dst = y + static_cast<size_t>(c) * shape.out_h * shape.out_w;
+                for (int t = 0; t < count; ++t) {
+                    const int oy0  = (t0 + t) / tiles_w * TILE_OUT;
+                    const int ox0  = (t0 + t) % tiles_w * TILE_OUT;
+                    const int rows = std::min(TILE_OUT, shape.out_h - oy0);
+                    const int cols = std::min(TILE_OUT, shape.out_w - ox0);
+                    for (int r = 0; r < rows; ++r) {
+                        float* line = dst + (oy0 + r) * shape.out_w + ox0;
+                        for (int col = 0; col < cols; ++col) {
+                            line[col] = d[(r * TILE_OUT + col) * block + t];
+                        }
+                    }
+                }
+            }
+        }
+        scratch.Release(slot);
+    };
+
+    if (pool) {
+        pool->ParallelFor(0, blocks, run_blocks);
+    } else {
+        run_blocks(0, blocks);
+    }
+    return !failed.load();
+}
+} // namespace kernel
+} // namespace nn
@@ -0,0 +1,53 @@
+#ifndef SIMPLE_NN_KERNEL_WINOGRAD_H_
+#define SIMPLE_NN_KERNEL_WINOGRAD_H_
+
+#include "runtime/cpu.h"
+#include "runtime/kernel/activation.h"
+#include "runtime/kernel/conv_kernel.h"
+#include "runtime/thread_pool.h"
+#include "utils/scratch_pool.h"
+
+#include <cstddef>
+
+namespace nn {
+namespace kernel {
+// F(4x4, 3x3) turns every 6x6 input tile into a 4x4 output tile with 36 products per input
+// and output channel pair instead of 144, at the price of transforming inputs and outputs
+
+/// @brief whether winograd beats im2col gemm for a 3x3 stride 1 convolution with these
+/// channel counts on the given isa, the transforms dominate for small ones
+bool Conv3x3WinogradProfitable(int in_channels, int out_channels, CpuIsa isa);
+
+/// @brief floats of the transformed weight, 36 x out_channels x in_channels
+size_t Conv3x3WinogradWeightSize(int in_channels, int out_channels);
+
+/// @brief U = G g G^T of every [out_channels, in_channels, 3, 3] filter, stored as 36 row
+/// major out_channels x in_channels gemm A operands
+void Conv3x3WinogradTransformWeight(const float* weight,
+                                    int in_channels,
+                                    int out_channels,
+                                    float* transformed);
+
+/// @brief bytes of scratch one thread running Conv3x3Winograd needs, the transformed inputs
+/// and products of one panel of tiles. independent of the image size
+size_t Conv3x3WinogradScratchSize(int in_channels, int out_channels, CpuIsa isa);
+
+/// @brief 3x3 stride 1 dilation 1 convolution of one image with a weight transformed by
+/// Conv3x3WinogradTransformWeight, pads of any size. every running chunk takes a slot of
+/// scratch, returns false when the slots are smaller than Conv3x3WinogradScratchSize or a
+/// missing one can not be allocated
+bool Conv3x3Winograd(const ConvShape& shape,
+                     int in_channels,
+                     int out_channels,
+                     const float* x,
+                     const float* transformed,
+                     const float* bias,
+                     const Activation& activation,
+                     float* y,
+                     CpuIsa isa,
+                     ScratchPool& scratch,
+                     ThreadPool* pool);
+} // namespace kernel
+} // namespace nn
+
+#endif // SIMPLE_NN_KERNEL_WINOGRAD_H_
@@ -1,5 +1,7 @@
 #include "runtime/layer.h"
 
+#include "runtime/compiled_model.h"
+
 #include <log.h>
 
 namespace nn {
@@ -10,10 +12,77 @@ MStatus Layer::Init(const std::map<std::string, pnnx::Parameter>& params) {
     return MStatus::M_OK;
 }
 
-MStatus Layer::Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output) {
+MStatus Layer::Load(const std::map<std::string, pnnx::Attribute>& attrs) {
+    return MStatus::M_OK;
+}
+
+MStatus Layer::SavePacked(CompiledWriter& writer) const {
+    return MStatus::M_OK;
+}
+
+MStatus Layer::LoadPacked(CompiledReader& reader) {
+    return MStatus::M_OK;
+}
+
+MStatus Layer::Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const {
     SIMPLE_LOG_DEBUG("{} Layer::Load Start\n", name_);
     SIMPLE_LOG_DEBUG("{} Layer::Load End\n", name_);
     return MStatus::M_NOT_SUPPORT;
 }
 
+MStatus Layer::InferShape(const std::vector<std::vector<int>>& input,
+                          std::vector<std::vector<int>>& output) const {
+    return MStatus::M_NOT_SUPPORT;
+}
+
+uint64_t Layer::GetFlops(const std::vector<Mat>& input, const std::vector<Mat>& output) const {
+    return 0;
+}
+
+size_t Layer::GetScratchSize() const {
+    return 0;
+}
+
+void Layer::ParallelFor(int64_t begin,
+                        int64_t end,
+                        const ThreadPool::RangeTask& fn,
+                        int64_t grain) const {
+    if (option_ && option_->thread_pool) {
+        option_->thread_pool->ParallelFor(begin, end, fn, grain);
+    } else if (begin < end) {
+        fn(begin, end);
+    }
+}
+
+MStatus Layer::InitActivation(const std::map<std::string, pnnx::Parameter>& params,
+                              kernel::Activation& activation,
+                              const std::string& prefix) const {
+    activation = kernel::Activation();
+    auto type  = params.find(prefix + "activation");
+    if (type == params.end()) {
+        return MStatus::M_OK;
+    }
+    if (type->second.s == "relu") {
+        activation.type = kernel::ActivationType::M_RELU;
+    } else if (type->second.s == "silu") {
+        activation.type = kernel::ActivationType::M_SILU;
+    } else if (type->second.s == "leaky_relu") {
+        activation.type  = kernel::ActivationType::M_LEAKY_RELU;
+        auto slope       = params.find(prefix + "negative_slope");
+        activation.alpha = slope != params.end() ? slope->second.f : 0.01f;
+    } else {
+        SIMPLE_LOG_ERROR("%s unknown activation %s\n", name_.c_str(), type->second.s.c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+    return MStatus::M_OK;
+}
+
+const float* Layer::GetFloat32Data(const pnnx::Attribute& attr, std::vector<float>& buffer) const {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(attr.view);
+    if (attr.view && attr.type == 1 && address % alignof(float) == 0) {
+        return reinterpret_cast<const float*>(attr.view);
+    }
+    buffer = attr.get_float32_data();
+    return buffer.data();
+}
 } // namespace nn
@@ -2,7 +2,11 @@
 #define SIMPLE_NN_LAYER_H_
 
 #include "pnnx/ir.h"
+#include "runtime/kernel/activation.h"
+#include "runtime/mat.h"
 #include "runtime/net.h"
+#include "runtime/net_option.h"
+#include "utils/scratch_pool.h"
 
 #include <common.h>
 #include <string>
@@ -11,6 +15,9 @@ namespace nn {
 
 enum class LayerType {};
 
+class CompiledWriter;
+class CompiledReader;
+
 class Layer {
 public:
     using TensorPtr = std::shared_ptr<base::Tensor>;
@@ -21,13 +28,62 @@ public:
 
     virtual MStatus Init(const std::map<std::string, pnnx::Parameter>& params);
 
-    virtual MStatus Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output);
+    /// @brief load weights, called once after Init, kernels repack them here
+    virtual MStatus Load(const std::map<std::string, pnnx::Attribute>& attrs);
+
+    /// @brief store the kernel ready weights and the choices Load made into a compiled model,
+    /// called after Load by Net::SaveCompiled
+    virtual MStatus SavePacked(CompiledWriter& writer) const;
+
+    /// @brief restore what SavePacked stored, called after Init in place of Load. weights
+    /// stay views into the mapped compiled model owned by the net
+    virtual MStatus LoadPacked(CompiledReader& reader);
+
+    /// @brief run the layer, output mats are already bound to planned memory with their shape set
+    virtual MStatus Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const;
+
+    /// @brief output shapes for the given input shapes, lets the net plan input shapes other
+    /// than the ones the model was exported with. layers that do not implement it only run
+    /// with their static shapes
+    /// @return M_INVALID_ARG when the layer cannot take the input shapes
+    virtual MStatus InferShape(const std::vector<std::vector<int>>& input,
+                               std::vector<std::vector<int>>& output) const;
+
+    /// @brief floating point operations of one Forward on these mats, reported by the
+    /// profiler, 0 when the layer does not count them
+    virtual uint64_t GetFlops(const std::vector<Mat>& input,
+                              const std::vector<Mat>& output) const;
+
+    /// @brief bytes of scratch memory one thread needs while running Forward, the net
+    /// allocates its ScratchPool once for the largest of its layers. 0 when there is none
+    virtual size_t GetScratchSize() const;
 
     const std::string GetName() const { return name_; }
 
+    /// @brief pnnx op type the layer was created for
+    const std::string& GetTypeName() const { return type_name_; }
+
 protected:
     friend class Net;
 
+    /// @brief run fn over [begin, end) on the net thread pool, inline when there is none
+    void ParallelFor(int64_t begin,
+                     int64_t end,
+                     const ThreadPool::RangeTask& fn,
+                     int64_t grain = 1) const;
+
+    /// @brief read the activation the graph optimizer fused into this op, the param
+    /// prefix + activation names relu, leaky_relu (with prefix + negative_slope) or silu,
+    /// none when it is absent
+    MStatus InitActivation(const std::map<std::string, pnnx::Parameter>& params,
+                           kernel::Activation& activation,
+                           const std::string& prefix = "") const;
+
+    /// @brief fp32 data of a weight without a copy when attr is an aligned fp32 view into the
+    /// mapped model file, otherwise converted into buffer
+    /// @param buffer storage of the converted copy, must outlive the returned pointer
+    const float* GetFloat32Data(const pnnx::Attribute& attr, std::vector<float>& buffer) const;
+
 protected:
     // layer name
     std::string name_;
@@ -35,11 +91,14 @@ protected:
     // layer type
     LayerType type_;
 
+    // pnnx op type
+    std::string type_name_;
+
     // tensor shape which this layer needs as input
-    std::vector<std::vector<uint8_t>> input_shape_{};
+    std::vector<std::vector<int>> input_shape_{};
 
     // tensor shape which this layer produces as output
-    std::vector<std::vector<uint8_t>> output_shape_{};
+    std::vector<std::vector<int>> output_shape_{};
 
     // tensor index which this layer needs as input
     std::vector<int> bottom_{};
@@ -49,6 +108,12 @@ protected:
 
     // custom user data
     std::shared_ptr<uint8_t> data_{nullptr};
+
+    // option of the net owning this layer
+    std::shared_ptr<NetOption> option_{nullptr};
+
+    // scratch shared by the layers of the net, set after Load when GetScratchSize is not 0
+    std::shared_ptr<ScratchPool> scratch_{nullptr};
 };
 } // namespace nn
 
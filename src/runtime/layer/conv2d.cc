@@ -0,0 +1,336 @@
+#include "runtime/layer/conv2d.h"
+
+#include "runtime/compiled_model.h"
+#include "runtime/kernel/conv.h"
+#include "runtime/kernel/gemm.h"
+#include "runtime/kernel/winograd.h"
+
+#include <cstring>
+#include <log.h>
+
+namespace nn {
+namespace {
+// pnnx writes spatial params as (h, w) lists, a single int applies to both
+bool GetPair(const std::map<std::string, pnnx::Parameter>& params,
+             const std::string& key,
+             int& h,
+             int& w) {
+    auto it = params.find(key);
+    if (it == params.end()) {
+        return true;
+    }
+    const pnnx::Parameter& param = it->second;
+    if (param.type == 2) {
+        h = param.i;
+        w = param.i;
+        return true;
+    }
+    if (param.type == 5 && param.ai.size() == 1) {
+        h = param.ai[0];
+        w = param.ai[0];
+        return true;
+    }
+    if (param.type == 5 && param.ai.size() == 2) {
+        h = param.ai[0];
+        w = param.ai[1];
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+MStatus Conv2d::Init(const std::map<std::string, pnnx::Parameter>& params) {
+    auto in_channels  = params.find("in_channels");
+    auto out_channels = params.find("out_channels");
+    if (in_channels == params.end() || out_channels == params.end()) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Init miss in_channels or out_channels\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    in_channels_  = in_channels->second.i;
+    out_channels_ = out_channels->second.i;
+    if (in_channels_ <= 0 || out_channels_ <= 0) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Init bad channels %i, %i\n",
+                         name_.c_str(),
+                         in_channels_,
+                         out_channels_);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    auto groups = params.find("groups");
+    if (groups != params.end()) {
+        groups_ = groups->second.i;
+    }
+    if (groups_ <= 0 || in_channels_ % groups_ || out_channels_ % groups_) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Init groups %i does not divide channels %i, %i\n",
+                         name_.c_str(),
+                         groups_,
+                         in_channels_,
+                         out_channels_);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    if (!GetPair(params, "kernel_size", kernel_h_, kernel_w_) ||
+        !GetPair(params, "stride", stride_h_, stride_w_) ||
+        !GetPair(params, "dilation", dilation_h_, dilation_w_)) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Init bad kernel_size, stride or dilation\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    auto padding = params.find("padding");
+    if (padding != params.end() && padding->second.type == 4) {
+        // same keeps the size for stride 1, only symmetric padding is supported
+        if (padding->second.s == "same") {
+            const int total_h = dilation_h_ * (kernel_h_ - 1);
+            const int total_w = dilation_w_ * (kernel_w_ - 1);
+            if (total_h % 2 || total_w % 2) {
+                SIMPLE_LOG_ERROR("%s Conv2d::Init asymmetric same padding\n", name_.c_str());
+                return MStatus::M_NOT_SUPPORT;
+            }
+            pad_h_ = total_h / 2;
+            pad_w_ = total_w / 2;
+        } else if (padding->second.s != "valid") {
+            SIMPLE_LOG_ERROR("%s Conv2d::Init unknown padding %s\n",
+                             name_.c_str(),
+                             padding->second.s.c_str());
+            return MStatus::M_INVALID_ARG;
+        }
+    } else if (!GetPair(params, "padding", pad_h_, pad_w_)) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Init bad padding\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    auto padding_mode = params.find("padding_mode");
+    if (padding_mode != params.end() && padding_mode->second.type == 4 &&
+        padding_mode->second.s != "zeros") {
+        SIMPLE_LOG_ERROR("%s Conv2d::Init padding_mode %s not support\n",
+                         name_.c_str(),
+                         padding_mode->second.s.c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    if (kernel_h_ <= 0 || kernel_w_ <= 0 || stride_h_ <= 0 || stride_w_ <= 0 ||
+        dilation_h_ <= 0 || dilation_w_ <= 0 || pad_h_ < 0 || pad_w_ < 0) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Init bad geometry\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    auto bias  = params.find("bias");
+    bias_term_ = bias != params.end() && bias->second.type == 1 && bias->second.b;
+    return InitActivation(params, activation_);
+}
+
+MStatus Conv2d::Load(const std::map<std::string, pnnx::Attribute>& attrs) {
+    const int weight_size = out_channels_ * (in_channels_ / groups_) * kernel_h_ * kernel_w_;
+    auto weight           = attrs.find("weight");
+    if (weight == attrs.end() || weight->second.elemcount() != weight_size) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Load weight mismatch [%i, %i, %i, %i]\n",
+                         name_.c_str(),
+                         out_channels_,
+                         in_channels_ / groups_,
+                         kernel_h_,
+                         kernel_w_);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    isa_                    = ResolveCpuIsa(option_ ? option_->cpu_isa : CpuIsa::M_AUTO);
+    ConvAlgorithm algorithm = option_ ? option_->conv_algorithm : ConvAlgorithm::M_AUTO;
+    if (IsWinogradCandidate()) {
+        // small channel counts fall back to im2col, their transforms cost more than they save
+        winograd_ = algorithm == ConvAlgorithm::M_WINOGRAD ||
+                    (algorithm == ConvAlgorithm::M_AUTO &&
+                     kernel::Conv3x3WinogradProfitable(in_channels_, out_channels_, isa_));
+    }
+
+    std::vector<float> buffer;
+    const float* weight_data = GetFloat32Data(weight->second, buffer);
+    if (winograd_) {
+        const size_t size = kernel::Conv3x3WinogradWeightSize(in_channels_, out_channels_);
+        if (!weight_.Resize(size * sizeof(float))) {
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+        kernel::Conv3x3WinogradTransformWeight(
+            weight_data, in_channels_, out_channels_, weight_.As<float>());
+        weight_data_ = weight_.As<float>();
+    } else if (buffer.empty()) {
+        // the torch layout [out, in / groups, kh, kw] already is the row major A operand of
+        // the im2col gemm and the filter bank of depthwise, so a mapped weight is used in place
+        weight_data_    = weight_data;
+        weight_mapping_ = weight->second.mapping;
+    } else {
+        if (!weight_.Resize(weight_size * sizeof(float))) {
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+        memcpy(weight_.Data(), weight_data, weight_size * sizeof(float));
+        weight_data_ = weight_.As<float>();
+    }
+
+    if (bias_term_) {
+        auto bias = attrs.find("bias");
+        if (bias == attrs.end() || bias->second.elemcount() != out_channels_) {
+            SIMPLE_LOG_ERROR("%s Conv2d::Load bias mismatch %i\n", name_.c_str(), out_channels_);
+            return MStatus::M_INVALID_ARG;
+        }
+        std::vector<float> bias_data = bias->second.get_float32_data();
+        if (!bias_.Resize(bias_data.size() * sizeof(float))) {
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+        memcpy(bias_.Data(), bias_data.data(), bias_data.size() * sizeof(float));
+        bias_data_ = bias_.As<float>();
+    }
+    return MStatus::M_OK;
+}
+
+size_t Conv2d::WeightSize() const {
+    if (winograd_) {
+        return kernel::Conv3x3WinogradWeightSize(in_channels_, out_channels_);
+    }
+    return static_cast<size_t>(out_channels_) * (in_channels_ / groups_) * kernel_h_ * kernel_w_;
+}
+
+MStatus Conv2d::SavePacked(CompiledWriter& writer) const {
+    writer.WriteInt(static_cast<int64_t>(isa_));
+    writer.WriteInt(winograd_ ? 1 : 0);
+    writer.WriteBuffer(weight_data_, WeightSize() * sizeof(float));
+    writer.WriteBuffer(bias_data_, bias_term_ ? out_channels_ * sizeof(float) : 0);
+    return MStatus::M_OK;
+}
+
+MStatus Conv2d::LoadPacked(CompiledReader& reader) {
+    const void* weight = nullptr;
+    const void* bias   = nullptr;
+    size_t weight_size = 0;
+    size_t bias_size   = 0;
+    CpuIsa packed_isa  = CpuIsa::M_GENERIC;
+    if (!reader.ReadInt(packed_isa) || !reader.ReadInt(winograd_) ||
+        !reader.ReadBuffer(weight, weight_size) || !reader.ReadBuffer(bias, bias_size)) {
+        SIMPLE_LOG_ERROR("%s Conv2d::LoadPacked truncated record\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    isa_ = ResolveCpuIsa(option_ ? option_->cpu_isa : CpuIsa::M_AUTO);
+    if (!kernel::GemmPackedCompatible(packed_isa, isa_) ||
+        (winograd_ && !IsWinogradCandidate()) || weight_size != WeightSize() * sizeof(float) ||
+        bias_size != (bias_term_ ? out_channels_ * sizeof(float) : 0)) {
+        SIMPLE_LOG_ERROR("%s Conv2d::LoadPacked weight mismatch\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    weight_data_ = static_cast<const float*>(weight);
+    bias_data_   = static_cast<const float*>(bias);
+    return MStatus::M_OK;
+}
+
+MStatus Conv2d::Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const {
+    if (input.size() != 1 || output.size() != 1) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Forward expect 1 input and 1 output\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // [..., c, h, w], every leading dimension is a batch of images
+    const Mat& x = input[0];
+    Mat& y       = output[0];
+    if (x.dims < 3 || y.dims < 3) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Forward expect [n, c, h, w]\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    kernel::ConvShape shape;
+    shape.in_h       = x.shape[x.dims - 2];
+    shape.in_w       = x.shape[x.dims - 1];
+    shape.out_h      = y.shape[y.dims - 2];
+    shape.out_w      = y.shape[y.dims - 1];
+    shape.kernel_h   = kernel_h_;
+    shape.kernel_w   = kernel_w_;
+    shape.stride_h   = stride_h_;
+    shape.stride_w   = stride_w_;
+    shape.pad_h      = pad_h_;
+    shape.pad_w      = pad_w_;
+    shape.dilation_h = dilation_h_;
+    shape.dilation_w = dilation_w_;
+
+    const size_t in_image  = static_cast<size_t>(in_channels_) * shape.in_h * shape.in_w;
+    const size_t out_image = static_cast<size_t>(out_channels_) * shape.out_h * shape.out_w;
+    const int out_h = (shape.in_h + 2 * pad_h_ - dilation_h_ * (kernel_h_ - 1) - 1) / stride_h_ + 1;
+    const int out_w = (shape.in_w + 2 * pad_w_ - dilation_w_ * (kernel_w_ - 1) - 1) / stride_w_ + 1;
+    if (x.shape[x.dims - 3] != in_channels_ || y.shape[y.dims - 3] != out_channels_ ||
+        shape.out_h != out_h || shape.out_w != out_w || !in_image ||
+        x.total() / in_image != y.total() / out_image) {
+        SIMPLE_LOG_ERROR("%s Conv2d::Forward shape mismatch\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    ThreadPool* pool   = option_ ? option_->thread_pool.get() : nullptr;
+    const float* bias  = bias_data_;
+    const size_t batch = x.total() / in_image;
+    for (size_t n = 0; n < batch; ++n) {
+        const float* src = x.data + n * in_image;
+        float* dst       = y.data + n * out_image;
+        if (winograd_) {
+            if (!scratch_ || !kernel::Conv3x3Winograd(shape,
+                                                      in_channels_,
+                                                      out_channels_,
+                                                      src,
+                                                      weight_data_,
+                                                      bias,
+                                                      activation_,
+                                                      dst,
+                                                      isa_,
+                                                      *scratch_,
+                                                      pool)) {
+                SIMPLE_LOG_ERROR("%s Conv2d::Forward winograd scratch unavailable\n", name_.c_str());
+                return MStatus::M_OUT_OF_MEMORY;
+            }
+        } else if (IsDepthwise()) {
+            kernel::Conv2dDepthwise(
+                shape, in_channels_, src, weight_data_, bias, activation_, dst, isa_, pool);
+        } else {
+            kernel::Conv2dIm2colGemm(shape,
+                                     in_channels_,
+                                     out_channels_,
+                                     groups_,
+                                     src,
+                                     weight_data_,
+                                     bias,
+                                     activation_,
+                                     dst,
+                                     isa_,
+                                     pool);
+        }
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Conv2d::InferShape(const std::vector<std::vector<int>>& input,
+                           std::vector<std::vector<int>>& output) const {
+    if (input.size() != 1 || input[0].size() < 3 ||
+        input[0][input[0].size() - 3] != in_channels_) {
+        SIMPLE_LOG_ERROR("%s Conv2d::InferShape expect [..., %i, h, w]\n",
+                         name_.c_str(),
+                         in_channels_);
+        return MStatus::M_INVALID_ARG;
+    }
+    const size_t dims = input[0].size();
+    const int in_h    = input[0][dims - 2];
+    const int in_w    = input[0][dims - 1];
+    if (in_h + 2 * pad_h_ < dilation_h_ * (kernel_h_ - 1) + 1 ||
+        in_w + 2 * pad_w_ < dilation_w_ * (kernel_w_ - 1) + 1) {
+        SIMPLE_LOG_ERROR("%s Conv2d::InferShape input %ix%i smaller than the kernel\n",
+                         name_.c_str(),
+                         in_h,
+                         in_w);
+        return MStatus::M_INVALID_ARG;
+    }
+    output.assign(1, input[0]);
+    output[0][dims - 3] = out_channels_;
+    output[0][dims - 2] = (in_h + 2 * pad_h_ - dilation_h_ * (kernel_h_ - 1) - 1) / stride_h_ + 1;
+    output[0][dims - 1] = (in_w + 2 * pad_w_ - dilation_w_ * (kernel_w_ - 1) - 1) / stride_w_ + 1;
+    return MStatus::M_OK;
+}
+
+size_t Conv2d::GetScratchSize() const {
+    return winograd_ ? kernel::Conv3x3WinogradScratchSize(in_channels_, out_channels_, isa_) : 0;
+}
+
+uint64_t Conv2d::GetFlops(const std::vector<Mat>& input, const std::vector<Mat>& output) const {
+    // a multiply and an add per output element and filter tap of its group
+    const uint64_t taps = static_cast<uint64_t>(in_channels_ / groups_) * kernel_h_ * kernel_w_;
+    return output.empty() ? 0 : 2 * static_cast<uint64_t>(output[0].total()) * taps;
+}
+} // namespace nn
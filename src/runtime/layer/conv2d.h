@@ -0,0 +1,82 @@
+#ifndef SIMPLE_NN_CONV2D_H_
+#define SIMPLE_NN_CONV2D_H_
+
+#include "runtime/layer.h"
+#include "utils/aligned_buffer.h"
+
+namespace nn {
+constexpr char kConv2dType[] = "nn.Conv2d";
+class Conv2d : public Layer {
+public:
+    Conv2d()  = default;
+    ~Conv2d() = default;
+
+    MStatus Init(const std::map<std::string, pnnx::Parameter>& params) override;
+
+    MStatus Load(const std::map<std::string, pnnx::Attribute>& attrs) override;
+
+    MStatus SavePacked(CompiledWriter& writer) const override;
+
+    MStatus LoadPacked(CompiledReader& reader) override;
+
+    MStatus Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const override;
+
+    MStatus InferShape(const std::vector<std::vector<int>>& input,
+                       std::vector<std::vector<int>>& output) const override;
+
+    uint64_t GetFlops(const std::vector<Mat>& input,
+                      const std::vector<Mat>& output) const override;
+
+    size_t GetScratchSize() const override;
+
+private:
+    bool IsDepthwise() const {
+        return groups_ > 1 && groups_ == in_channels_ && groups_ == out_channels_;
+    }
+
+    // floats behind weight_data_
+    size_t WeightSize() const;
+
+    bool IsWinogradCandidate() const {
+        return kernel_h_ == 3 && kernel_w_ == 3 && stride_h_ == 1 && stride_w_ == 1 &&
+               dilation_h_ == 1 && dilation_w_ == 1 && groups_ == 1;
+    }
+
+private:
+    int in_channels_{0};
+    int out_channels_{0};
+    int kernel_h_{1};
+    int kernel_w_{1};
+    int stride_h_{1};
+    int stride_w_{1};
+    int pad_h_{0};
+    int pad_w_{0};
+    int dilation_h_{1};
+    int dilation_w_{1};
+    int groups_{1};
+    bool bias_term_{false};
+
+    // fused by the graph optimizer, applied in the kernel epilogue
+    kernel::Activation activation_{};
+
+    // kernel level the weight was laid out for
+    CpuIsa isa_{CpuIsa::M_GENERIC};
+
+    // weight_ holds the winograd transformed filters instead
+    bool winograd_{false};
+
+    // weight [out_channels, in_channels / groups * kernel_h * kernel_w], the A operand of the
+    // im2col gemm, [channels, kernel_h * kernel_w] filters for depthwise or
+    // [36, out_channels, in_channels] for winograd
+    const float* weight_data_{nullptr};
+
+    // owns weight_data_ unless it points into the mapped model file kept by weight_mapping_
+    // or into a compiled model
+    AlignedBuffer weight_;
+    std::shared_ptr<const void> weight_mapping_{nullptr};
+    const float* bias_data_{nullptr};
+    AlignedBuffer bias_;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_CONV2D_H_
@@ -0,0 +1,180 @@
+#include "runtime/layer/elementwise.h"
+
+#include "runtime/compiled_model.h"
+
+#include <algorithm>
+#include <cstring>
+#include <log.h>
+
+namespace nn {
+namespace {
+// floats processed by every stage before moving on, small enough to stay in L1
+constexpr size_t CHUNK = 4096;
+} // namespace
+
+MStatus Elementwise::Init(const std::map<std::string, pnnx::Parameter>& params) {
+    auto stages = params.find("stages");
+    if (stages == params.end() || stages->second.i <= 0) {
+        SIMPLE_LOG_ERROR("%s Elementwise::Init miss stages\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    stages_.resize(stages->second.i);
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        MStatus ret = InitActivation(params, stages_[i].activation, std::to_string(i) + ".");
+        if (ret != MStatus::M_OK) {
+            return ret;
+        }
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Elementwise::Load(const std::map<std::string, pnnx::Attribute>& attrs) {
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        Stage& stage = stages_[i];
+        if (stage.activation.type != kernel::ActivationType::M_NONE) {
+            continue;
+        }
+        auto scale = attrs.find(std::to_string(i) + ".scale");
+        auto shift = attrs.find(std::to_string(i) + ".shift");
+        if (scale == attrs.end() || shift == attrs.end() ||
+            scale->second.elemcount() != shift->second.elemcount()) {
+            SIMPLE_LOG_ERROR("%s Elementwise::Load stage %i miss scale or shift\n",
+                             name_.c_str(),
+                             i);
+            return MStatus::M_INVALID_ARG;
+        }
+        stage.scale = scale->second.get_float32_data();
+        stage.shift = shift->second.get_float32_data();
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Elementwise::SavePacked(CompiledWriter& writer) const {
+    for (const Stage& stage : stages_) {
+        writer.WriteBuffer(stage.scale.data(), stage.scale.size() * sizeof(float));
+        writer.WriteBuffer(stage.shift.data(), stage.shift.size() * sizeof(float));
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Elementwise::LoadPacked(CompiledReader& reader) {
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        Stage& stage      = stages_[i];
+        const void* scale = nullptr;
+        const void* shift = nullptr;
+        size_t scale_size = 0;
+        size_t shift_size = 0;
+        const bool affine = stage.activation.type == kernel::ActivationType::M_NONE;
+        if (!reader.ReadBuffer(scale, scale_size) || !reader.ReadBuffer(shift, shift_size) ||
+            scale_size != shift_size || affine != (scale_size > 0)) {
+            SIMPLE_LOG_ERROR("%s Elementwise::LoadPacked stage %i mismatch\n", name_.c_str(), i);
+            return MStatus::M_INVALID_ARG;
+        }
+        const float* scale_data = static_cast<const float*>(scale);
+        const float* shift_data = static_cast<const float*>(shift);
+        stage.scale.assign(scale_data, scale_data + scale_size / sizeof(float));
+        stage.shift.assign(shift_data, shift_data + shift_size / sizeof(float));
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Elementwise::Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const {
+    if (input.size() != 1 || output.size() != 1 || input[0].total() != output[0].total()) {
+        SIMPLE_LOG_ERROR("%s Elementwise::Forward expect 1 input and 1 output of one size\n",
+                         name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // [n, c, ...] applies affine stages along c, lower ranks have a single channel
+    const Mat& x         = input[0];
+    Mat& y               = output[0];
+    const int channels   = x.dims >= 2 ? x.shape[1] : 1;
+    const size_t inner   = x.dims >= 2 ? x.total() / x.shape[0] / channels : x.total();
+    const int64_t planes = static_cast<int64_t>(x.total() / inner);
+    for (const auto& stage : stages_) {
+        if (stage.activation.type == kernel::ActivationType::M_NONE &&
+            stage.scale.size() != static_cast<size_t>(channels)) {
+            SIMPLE_LOG_ERROR("%s Elementwise::Forward expect %i channels, got %i\n",
+                             name_.c_str(),
+                             stage.scale.size(),
+                             channels);
+            return MStatus::M_INVALID_ARG;
+        }
+    }
+
+    // count floats from offset through every stage, the channel is c for all of them or, for
+    // rows of [n, c], starts at c and advances with every float
+    auto run = [&](size_t offset, size_t count, int c, bool rows) {
+        const float* src = x.data + offset;
+        float* dst       = y.data + offset;
+        if (src != dst) {
+            memcpy(dst, src, count * sizeof(float));
+        }
+        for (const auto& stage : stages_) {
+            if (stage.activation.type != kernel::ActivationType::M_NONE) {
+                kernel::ApplyActivation(stage.activation, dst, count);
+            } else if (!rows) {
+                const float scale = stage.scale[c];
+                const float shift = stage.shift[c];
+                for (size_t j = 0; j < count; ++j) {
+                    dst[j] = dst[j] * scale + shift;
+                }
+            } else {
+                // row by row, the channels of a row are contiguous like the floats
+                for (size_t j = 0, k = c; j < count; j += channels - k, k = 0) {
+                    const size_t n     = std::min(count - j, channels - k);
+                    const float* scale = stage.scale.data() + k;
+                    const float* shift = stage.shift.data() + k;
+                    float* row         = dst + j;
+                    for (size_t t = 0; t < n; ++t) {
+                        row[t] = row[t] * scale[t] + shift[t];
+                    }
+                }
+            }
+        }
+    };
+
+    if (inner == 1) {
+        // one float per plane, split the contiguous rows instead so chunks stay CHUNK long
+        const size_t total   = x.total();
+        const int64_t chunks = static_cast<int64_t>((total + CHUNK - 1) / CHUNK);
+        ParallelFor(0, chunks, [&](int64_t begin, int64_t end) {
+            for (int64_t b = begin; b < end; ++b) {
+                const size_t offset = b * CHUNK;
+                run(offset, std::min(CHUNK, total - offset), offset % channels, true);
+            }
+        });
+        return MStatus::M_OK;
+    }
+
+    ParallelFor(0, planes, [&](int64_t begin, int64_t end) {
+        for (int64_t p = begin; p < end; ++p) {
+            const int c = static_cast<int>(p % channels);
+            for (size_t i = 0; i < inner; i += CHUNK) {
+                run(p * inner + i, std::min(CHUNK, inner - i), c, false);
+            }
+        }
+    });
+    return MStatus::M_OK;
+}
+
+MStatus Elementwise::InferShape(const std::vector<std::vector<int>>& input,
+                                std::vector<std::vector<int>>& output) const {
+    if (input.size() != 1) {
+        SIMPLE_LOG_ERROR("%s Elementwise::InferShape expect 1 input\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    output = input;
+    return MStatus::M_OK;
+}
+
+uint64_t Elementwise::GetFlops(const std::vector<Mat>& input,
+                               const std::vector<Mat>& output) const {
+    // an affine stage is a multiply and an add, an activation is counted as one op
+    uint64_t ops = 0;
+    for (const auto& stage : stages_) {
+        ops += stage.activation.type == kernel::ActivationType::M_NONE ? 2 : 1;
+    }
+    return input.empty() ? 0 : ops * input[0].total();
+}
+} // namespace nn
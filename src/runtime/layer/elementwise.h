@@ -0,0 +1,46 @@
+#ifndef SIMPLE_NN_ELEMENTWISE_H_
+#define SIMPLE_NN_ELEMENTWISE_H_
+
+#include "runtime/layer.h"
+
+namespace nn {
+constexpr char kElementwiseType[] = "nn.Elementwise";
+
+/// @brief chain of pointwise stages produced by the graph optimizer from batchnorm and
+/// activation ops, all stages run on a chunk while it is in cache so the chain costs one
+/// pass over memory. params: stages count, stage i is either the activation i.activation
+/// or the per channel affine x * i.scale + i.shift given as attributes
+class Elementwise : public Layer {
+public:
+    Elementwise()  = default;
+    ~Elementwise() = default;
+
+    MStatus Init(const std::map<std::string, pnnx::Parameter>& params) override;
+
+    MStatus Load(const std::map<std::string, pnnx::Attribute>& attrs) override;
+
+    MStatus SavePacked(CompiledWriter& writer) const override;
+
+    MStatus LoadPacked(CompiledReader& reader) override;
+
+    MStatus Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const override;
+
+    MStatus InferShape(const std::vector<std::vector<int>>& input,
+                       std::vector<std::vector<int>>& output) const override;
+
+    uint64_t GetFlops(const std::vector<Mat>& input,
+                      const std::vector<Mat>& output) const override;
+
+private:
+    struct Stage {
+        // affine when activation is none
+        kernel::Activation activation;
+        std::vector<float> scale;
+        std::vector<float> shift;
+    };
+
+    std::vector<Stage> stages_;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_ELEMENTWISE_H_
@@ -1,15 +1,160 @@
 #include "runtime/layer/linear.h"
 
+#include "runtime/compiled_model.h"
+#include "runtime/kernel/gemm.h"
+
+#include <cstring>
+#include <log.h>
+
 namespace nn {
 
 MStatus Linear::Init(const std::map<std::string, pnnx::Parameter>& params) {
-    for (const auto& param : params) {
-        printf("%s\n", param.first.c_str());
+    auto in_features  = params.find("in_features");
+    auto out_features = params.find("out_features");
+    if (in_features == params.end() || out_features == params.end()) {
+        SIMPLE_LOG_ERROR("%s Linear::Init miss in_features or out_features\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    in_features_  = in_features->second.i;
+    out_features_ = out_features->second.i;
+    if (in_features_ <= 0 || out_features_ <= 0) {
+        SIMPLE_LOG_ERROR("%s Linear::Init bad features [%i, %i]\n",
+                         name_.c_str(),
+                         out_features_,
+                         in_features_);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    auto bias  = params.find("bias");
+    bias_term_ = bias != params.end() && bias->second.type == 1 && bias->second.b;
+    return InitActivation(params, activation_);
+}
+
+MStatus Linear::Load(const std::map<std::string, pnnx::Attribute>& attrs) {
+    auto weight = attrs.find("weight");
+    if (weight == attrs.end() || weight->second.elemcount() != in_features_ * out_features_) {
+        SIMPLE_LOG_ERROR("%s Linear::Load weight mismatch [%i, %i]\n",
+                         name_.c_str(),
+                         out_features_,
+                         in_features_);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // y = x * W^T, W^T is the B operand so W is packed transposed
+    isa_ = ResolveCpuIsa(option_ ? option_->cpu_isa : CpuIsa::M_AUTO);
+    std::vector<float> buffer;
+    const float* weight_data = GetFloat32Data(weight->second, buffer);
+    size_t packed_size = kernel::GemmPackedBSize(in_features_, out_features_, isa_) * sizeof(float);
+    if (!packed_weight_.Resize(packed_size)) {
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    kernel::GemmPackB(weight_data,
+                      in_features_,
+                      out_features_,
+                      in_features_,
+                      true,
+                      packed_weight_.As<float>(),
+                      isa_);
+    packed_data_ = packed_weight_.As<float>();
+
+    if (bias_term_) {
+        auto bias = attrs.find("bias");
+        if (bias == attrs.end() || bias->second.elemcount() != out_features_) {
+            SIMPLE_LOG_ERROR("%s Linear::Load bias mismatch %i\n", name_.c_str(), out_features_);
+            return MStatus::M_INVALID_ARG;
+        }
+        std::vector<float> bias_data = bias->second.get_float32_data();
+        if (!bias_.Resize(bias_data.size() * sizeof(float))) {
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+        memcpy(bias_.Data(), bias_data.data(), bias_data.size() * sizeof(float));
+        bias_data_ = bias_.As<float>();
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Linear::SavePacked(CompiledWriter& writer) const {
+    writer.WriteInt(static_cast<int64_t>(isa_));
+    writer.WriteBuffer(
+        packed_data_, kernel::GemmPackedBSize(in_features_, out_features_, isa_) * sizeof(float));
+    writer.WriteBuffer(bias_data_, bias_term_ ? out_features_ * sizeof(float) : 0);
+    return MStatus::M_OK;
+}
+
+MStatus Linear::LoadPacked(CompiledReader& reader) {
+    const void* packed = nullptr;
+    const void* bias   = nullptr;
+    size_t packed_size = 0;
+    size_t bias_size   = 0;
+    CpuIsa packed_isa  = CpuIsa::M_GENERIC;
+    if (!reader.ReadInt(packed_isa) || !reader.ReadBuffer(packed, packed_size) ||
+        !reader.ReadBuffer(bias, bias_size)) {
+        SIMPLE_LOG_ERROR("%s Linear::LoadPacked truncated record\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    // panels are laid out for one micro kernel, any level running it takes them
+    isa_ = ResolveCpuIsa(option_ ? option_->cpu_isa : CpuIsa::M_AUTO);
+    if (!kernel::GemmPackedCompatible(packed_isa, isa_) ||
+        packed_size !=
+            kernel::GemmPackedBSize(in_features_, out_features_, isa_) * sizeof(float) ||
+        bias_size != (bias_term_ ? out_features_ * sizeof(float) : 0)) {
+        SIMPLE_LOG_ERROR("%s Linear::LoadPacked weight mismatch\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
     }
+    packed_data_ = static_cast<const float*>(packed);
+    bias_data_   = static_cast<const float*>(bias);
     return MStatus::M_OK;
 }
 
-MStatus Linear::Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output) {
+MStatus Linear::Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const {
+    if (input.size() != 1 || output.size() != 1) {
+        SIMPLE_LOG_ERROR("%s Linear::Forward expect 1 input and 1 output\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // every leading dimension is a row of the gemm
+    const Mat& x = input[0];
+    Mat& y       = output[0];
+    const int M  = static_cast<int>(x.total() / in_features_);
+    if (x.total() != static_cast<size_t>(M) * in_features_ ||
+        y.total() != static_cast<size_t>(M) * out_features_) {
+        SIMPLE_LOG_ERROR("%s Linear::Forward shape mismatch\n", name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    kernel::GemmEpilogue epilogue;
+    epilogue.activation = activation_;
+    if (bias_term_) {
+        epilogue.bias      = bias_data_;
+        epilogue.bias_mode = kernel::BiasMode::M_COL;
+    }
+    kernel::SgemmPackedB(M,
+                         out_features_,
+                         in_features_,
+                         x.data,
+                         in_features_,
+                         packed_data_,
+                         y.data,
+                         out_features_,
+                         epilogue,
+                         isa_,
+                         option_ ? option_->thread_pool.get() : nullptr);
     return MStatus::M_OK;
 }
+
+MStatus Linear::InferShape(const std::vector<std::vector<int>>& input,
+                           std::vector<std::vector<int>>& output) const {
+    if (input.size() != 1 || input[0].empty() || input[0].back() != in_features_) {
+        SIMPLE_LOG_ERROR("%s Linear::InferShape expect [..., %i]\n", name_.c_str(), in_features_);
+        return MStatus::M_INVALID_ARG;
+    }
+    output.assign(1, input[0]);
+    output[0].back() = out_features_;
+    return MStatus::M_OK;
+}
+
+uint64_t Linear::GetFlops(const std::vector<Mat>& input, const std::vector<Mat>& output) const {
+    // a multiply and an add per weight and row
+    return input.empty() ? 0 : 2 * static_cast<uint64_t>(input[0].total()) * out_features_;
+}
 } // namespace nn
@@ -2,6 +2,7 @@
 #define SIMPLE_NN_LINEAR_H_
 
 #include "runtime/layer.h"
+#include "utils/aligned_buffer.h"
 
 namespace nn {
 constexpr char kLinearType[] = "nn.Linear";
@@ -12,8 +13,38 @@ public:
 
     MStatus Init(const std::map<std::string, pnnx::Parameter>& params) override;
 
-    MStatus Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output) override;
+    MStatus Load(const std::map<std::string, pnnx::Attribute>& attrs) override;
+
+    MStatus SavePacked(CompiledWriter& writer) const override;
+
+    MStatus LoadPacked(CompiledReader& reader) override;
+
+    MStatus Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const override;
+
+    MStatus InferShape(const std::vector<std::vector<int>>& input,
+                       std::vector<std::vector<int>>& output) const override;
+
+    uint64_t GetFlops(const std::vector<Mat>& input,
+                      const std::vector<Mat>& output) const override;
+
+private:
+    int in_features_{0};
+    int out_features_{0};
+    bool bias_term_{false};
+
+    // fused by the graph optimizer, applied in the kernel epilogue
+    kernel::Activation activation_{};
+
+    // kernel level the weight was packed for
+    CpuIsa isa_{CpuIsa::M_GENERIC};
+
+    // weight [out_features, in_features] repacked into gemm column panels, the buffers own
+    // the data unless it was restored from a compiled model
+    const float* packed_data_{nullptr};
+    const float* bias_data_{nullptr};
+    AlignedBuffer packed_weight_;
+    AlignedBuffer bias_;
 };
 } // namespace nn
 
-#endif // SIMPLE_NN_LINEAR_H_
\ No newline at end of file
+#endif // SIMPLE_NN_LINEAR_H_
@@ -1,13 +1,19 @@
 #include "source.h"
 
+#include <cstring>
+
 namespace nn {
 
 MStatus Source::Init(const std::map<std::string, pnnx::Parameter>& params) {
     return MStatus::M_OK;
 }
 
-MStatus Source::Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output) {
-    output = input;
+MStatus Source::Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const {
+    for (size_t i = 0; i < input.size() && i < output.size(); ++i) {
+        if (input[i].data != output[i].data) {
+            memcpy(output[i].data, input[i].data, input[i].total() * sizeof(float));
+        }
+    }
     return MStatus::M_OK;
 }
 } // namespace nn
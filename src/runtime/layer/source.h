@@ -13,7 +13,7 @@ public:
 
     MStatus Init(const std::map<std::string, pnnx::Parameter>& params) override;
 
-    MStatus Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output) override;
+    MStatus Forward(const std::vector<Mat>& input, std::vector<Mat>& output) const override;
 };
 } // namespace nn
 #endif // SIMPLE_NN_INPUT_H_
\ No newline at end of file
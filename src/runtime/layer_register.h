@@ -1,6 +1,8 @@
 #ifndef SIMPLE_NN_LAYEAR_REGISTER_H_
 #define SIMPLE_NN_LAYEAR_REGISTER_H_
 
+#include "runtime/layer/conv2d.h"
+#include "runtime/layer/elementwise.h"
 #include "runtime/layer/linear.h"
 #include "runtime/layer/source.h"
 
@@ -10,10 +12,13 @@ using namespace nn;
 
 REGISTER_COMMON_ENGINE(nn, Source, Layer, Source)
 REGISTER_COMMON_ENGINE(nn, Linear, Layer, Linear)
+REGISTER_COMMON_ENGINE(nn, Conv2d, Layer, Conv2d)
+REGISTER_COMMON_ENGINE(nn, Elementwise, Layer, Elementwise)
 
 // clang-format off
 static const std::multimap<std::string, std::string> layer_map{
     {"pnnx.Input", "Source"}, {"pnnx.Output", "Source"},
-    {"nn.Linear", "Linear"}};
+    {"nn.Linear", "Linear"}, {"nn.Conv2d", "Conv2d"},
+    {"nn.Elementwise", "Elementwise"}};
 
 #endif // SIMPLE_NN_LAYEAR_REGISTER_H_
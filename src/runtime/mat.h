@@ -0,0 +1,41 @@
+#ifndef SIMPLE_NN_MAT_H_
+#define SIMPLE_NN_MAT_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace nn {
+constexpr int MAX_MAT_DIMS = 6;
+
+/// @brief non-owning fp32 view over blob memory, the memory itself is owned by the net arena
+/// or by the caller tensor bound to a graph input/output
+class Mat {
+public:
+    Mat() : data(nullptr), dims(0) {}
+    Mat(float* _data, const std::vector<int>& _shape) : data(_data), dims(0) {
+        for (size_t i = 0; i < _shape.size() && i < MAX_MAT_DIMS; ++i) {
+            shape[dims++] = _shape[i];
+        }
+    }
+
+    size_t total() const {
+        if (!dims) {
+            return 0;
+        }
+        size_t size = 1;
+        for (int i = 0; i < dims; ++i) {
+            size *= static_cast<size_t>(shape[i]);
+        }
+        return size;
+    }
+
+    bool empty() const { return data == nullptr || total() == 0; }
+
+public:
+    float* data;
+    int dims;
+    int shape[MAX_MAT_DIMS];
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_MAT_H_
@@ -0,0 +1,69 @@
+#include "runtime/memory_planner.h"
+
+#include "utils/aligned_buffer.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace nn {
+size_t MemoryPlanner::Plan(const std::vector<Lifetime>& lifetimes,
+                           std::vector<size_t>& offsets) const {
+    return Plan(lifetimes, offsets, [&lifetimes](size_t a, size_t b) {
+        return lifetimes[a].first <= lifetimes[b].last && lifetimes[b].first <= lifetimes[a].last;
+    });
+}
+
+size_t MemoryPlanner::Plan(const std::vector<Lifetime>& lifetimes,
+                           std::vector<size_t>& offsets,
+                           const Conflict& conflict) const {
+    const size_t count = lifetimes.size();
+    offsets.assign(count, 0);
+
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&lifetimes](size_t a, size_t b) {
+        return lifetimes[a].size > lifetimes[b].size;
+    });
+
+    size_t arena_size = 0;
+    std::vector<size_t> placed;
+    std::vector<size_t> alive;
+    placed.reserve(count);
+    alive.reserve(count);
+    for (size_t idx : order) {
+        const size_t size = AlignSize(lifetimes[idx].size);
+
+        // placed blobs alive at the same time, ordered by offset
+        alive.clear();
+        for (size_t other : placed) {
+            if (conflict(idx, other)) {
+                alive.push_back(other);
+            }
+        }
+        std::sort(alive.begin(), alive.end(), [&offsets](size_t a, size_t b) {
+            return offsets[a] < offsets[b];
+        });
+
+        // best fit gap between alive blobs, otherwise append after the highest one
+        size_t best        = static_cast<size_t>(-1);
+        size_t best_gap    = static_cast<size_t>(-1);
+        size_t prev_offset = 0;
+        for (size_t other : alive) {
+            size_t gap_end = offsets[other];
+            if (gap_end >= prev_offset + size && gap_end - prev_offset < best_gap) {
+                best     = prev_offset;
+                best_gap = gap_end - prev_offset;
+            }
+            prev_offset = std::max(prev_offset, offsets[other] + AlignSize(lifetimes[other].size));
+        }
+        if (best == static_cast<size_t>(-1)) {
+            best = prev_offset;
+        }
+
+        offsets[idx] = best;
+        arena_size   = std::max(arena_size, best + size);
+        placed.push_back(idx);
+    }
+    return arena_size;
+}
+} // namespace nn
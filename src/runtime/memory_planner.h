@@ -0,0 +1,47 @@
+#ifndef SIMPLE_NN_MEMORY_PLANNER_H_
+#define SIMPLE_NN_MEMORY_PLANNER_H_
+
+#include <common.h>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace nn {
+/// @brief packs intermediate blobs into one arena, blobs whose lifetimes do not overlap
+/// share memory. offsets are assigned greedily by size, largest blob first, each blob takes
+/// the smallest gap left by the already placed blobs that are alive at the same time
+class MemoryPlanner {
+public:
+    struct Lifetime {
+        // blob index
+        int blob;
+        // bytes, rounded up to MEMORY_ALIGNMENT by the planner
+        size_t size;
+        // plan step which produces the blob
+        int first;
+        // last plan step which consumes the blob
+        int last;
+    };
+
+    // whether lifetimes[a] and lifetimes[b] may be alive at the same time
+    using Conflict = std::function<bool(size_t a, size_t b)>;
+
+public:
+    MemoryPlanner()  = default;
+    ~MemoryPlanner() = default;
+
+    /// @brief assign arena offsets
+    /// @param[in] lifetimes blobs to place
+    /// @param[out] offsets byte offset of lifetimes[i] inside the arena
+    /// @return total arena size in bytes, the peak activation memory
+    size_t Plan(const std::vector<Lifetime>& lifetimes, std::vector<size_t>& offsets) const;
+
+    /// @brief assign arena offsets with a custom conflict test, used when steps of the plan
+    /// may run concurrently and step intervals no longer describe liveness
+    size_t Plan(const std::vector<Lifetime>& lifetimes,
+                std::vector<size_t>& offsets,
+                const Conflict& conflict) const;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_MEMORY_PLANNER_H_
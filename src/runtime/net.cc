@@ -1,27 +1,61 @@
 #include "runtime/net.h"
 
+#include "runtime/compiled_model.h"
+#include "runtime/graph_optimizer.h"
+#include "runtime/kernel/gemm.h"
 #include "runtime/layer_register.h"
+#include "runtime/memory_planner.h"
+#include "runtime/session.h"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <iomanip>
-#include <regex>
+#include <queue>
 #include <register.h>
 #include <sstream>
+#include <unordered_map>
 
 namespace nn {
+namespace {
+// bytes of a float blob of the given shape, 0 when some dimension is unknown
+size_t BlobBytes(const std::vector<int>& shape) {
+    if (shape.empty()) {
+        return 0;
+    }
+    size_t size = sizeof(float);
+    for (int dim : shape) {
+        if (dim <= 0) {
+            return 0;
+        }
+        size *= static_cast<size_t>(dim);
+    }
+    return size;
+}
+} // namespace
+
 Net::Net(const Net& net)
     : net_name_(net.net_name_),
       option_(net.option_),
       blobs_(net.blobs_),
+      blob_index_(net.blob_index_),
       layers_(net.layers_),
+      layer_index_(net.layer_index_),
       input_blob_index_(net.input_blob_index_),
-      output_blob_index_(net.output_blob_index_) {}
+      output_blob_index_(net.output_blob_index_),
+      input_index_(net.input_index_),
+      output_index_(net.output_index_) {}
 
 Net& Net::operator=(const Net&) {
     return *this;
 }
 
-Net::Net(const std::string& name)
-    : net_name_(name), option_(nullptr), graph_(nullptr), blobs_({}), layers_({}) {}
+Net::Net(const std::string& name, const std::shared_ptr<NetOption>& option)
+    : net_name_(name), option_(option), graph_(nullptr), blobs_({}), layers_({}) {
+    if (nullptr == option_) {
+        option_ = std::make_shared<NetOption>();
+    }
+}
 
 
 const std::string Net::Summary() const {
@@ -84,10 +118,50 @@ const std::string Net::Summary() const {
     return ss.str();
 }
 
+void Net::InitThreadPool() {
+    // layers pick the pool up from the option during Init
+    if (!option_->thread_pool &&
+        (option_->num_threads > 1 || option_->executor_mode == ExecutorMode::M_PARALLEL)) {
+        option_->thread_pool = std::make_shared<ThreadPool>(
+            option_->num_threads, option_->spin_count, option_->cpu_affinity);
+    }
+}
+
+MStatus Net::InitScratch() {
+    size_t slot_size = 0;
+    for (const auto& layer : layers_) {
+        slot_size = std::max(slot_size, layer->GetScratchSize());
+    }
+    if (!slot_size) {
+        return MStatus::M_OK;
+    }
+
+    // a slot for every pool thread, every external caller adds its own on first use
+    auto scratch    = std::make_shared<ScratchPool>();
+    const int slots = option_->thread_pool ? option_->thread_pool->GetThreadNum() : 1;
+    if (!scratch->Resize(slots, slot_size)) {
+        SIMPLE_LOG_ERROR("Net::InitScratch %i slots of %i bytes failed\n",
+                         slots,
+                         static_cast<int>(slot_size));
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    for (auto& layer : layers_) {
+        if (layer->GetScratchSize()) {
+            layer->scratch_ = scratch;
+        }
+    }
+    return MStatus::M_OK;
+}
+
 MStatus Net::Init(const std::string& param, const std::string& bin) {
     SIMPLE_LOG_DEBUG("Net::Init Start\n");
     MStatus ret = MStatus::M_OK;
+    unsupported_op_.clear();
     do {
+        InitThreadPool();
+        SIMPLE_LOG_INFO("Net::Init kernels use %s\n",
+                        CpuIsaName(ResolveCpuIsa(option_->cpu_isa)));
+
         if (param.empty() || bin.empty()) {
             SIMPLE_LOG_ERROR(
                 "input param or bin path error! param:%s, bin:%s\n", param.c_str(), bin.c_str());
@@ -101,12 +175,15 @@ MStatus Net::Init(const std::string& param, const std::string& bin) {
             break;
         }
         SIMPLE_LOG_DEBUG("pnnx::Graph load %s, %s\n", param.c_str(), bin.c_str());
-        if (this->graph_->load(param, bin) < 0) {
+        if (this->graph_->load(param, bin, option_->use_mmap) < 0) {
             SIMPLE_LOG_ERROR("pnnx::Graph load param and bin failed\n");
             ret = MStatus::M_FAILED;
             break;
         }
 
+        // fold and fuse ops before they become layers
+        GraphOptimizer().Optimize(*this->graph_);
+
         std::vector<pnnx::Operator*> operators = this->graph_->ops;
         if (operators.empty()) {
             SIMPLE_LOG_ERROR("pnnx::Graph has no any operators\n");
@@ -114,8 +191,8 @@ MStatus Net::Init(const std::string& param, const std::string& bin) {
             break;
         }
 
-        // show net details
-        printf("%s\n", Summary().c_str());
+        // net details, building them costs a line per op so only when debugging
+        SIMPLE_LOG_DEBUG("%s\n", Summary().c_str());
 
         int layer_count = static_cast<int>(this->graph_->ops.size());
         int blob_count  = static_cast<int>(this->graph_->operands.size());
@@ -128,6 +205,15 @@ MStatus Net::Init(const std::string& param, const std::string& bin) {
         layers_.resize(layer_count);
         blobs_.resize(blob_count);
 
+        // blobs are numbered by operand position, any operand name works and none is parsed
+        std::unordered_map<const pnnx::Operand*, int> blob_index_of;
+        blob_index_of.reserve(blob_count);
+        for (int i = 0; i < blob_count; ++i) {
+            const pnnx::Operand* operand = this->graph_->operands[i];
+            blob_index_of[operand]       = i;
+            blobs_[i].name               = operand->name;
+        }
+
         // TODO: check model magic number
 
         for (int i = 0; i < layer_count; ++i) {
@@ -152,7 +238,8 @@ MStatus Net::Init(const std::string& param, const std::string& bin) {
             if (layer_type_ptr == layer_map.end()) {
                 SIMPLE_LOG_ERROR("layer map can't find %s layer\n",
                                  this->graph_->ops[i]->type.c_str());
-                ret = MStatus::M_NOT_SUPPORT;
+                unsupported_op_ = this->graph_->ops[i]->type;
+                ret             = MStatus::M_NOT_SUPPORT;
                 break;
             }
 
@@ -165,90 +252,887 @@ MStatus Net::Init(const std::string& param, const std::string& bin) {
                 break;
             }
 
+            layer->name_      = layer_name;
+            layer->type_name_ = this->graph_->ops[i]->type;
+            layer->option_    = option_;
             layer->bottom_.resize(bottom_count);
             for (int j = 0; j < bottom_count; ++j) {
-                std::string input_idx = this->graph_->ops[i]->inputs[j]->name;
-                std::regex rx("[0-9]+");
-                if (!std::regex_match(input_idx.begin(), input_idx.end(), rx)) {
-                    SIMPLE_LOG_ERROR("cread blob failed!, %s layer, %i blob is not number\n",
-                                     this->graph_->ops[i]->name.c_str(),
-                                     input_idx);
-                    ret = MStatus::M_NOT_SUPPORT;
-                    break;
-                }
-                int bottom_blob_index = std::atoi(input_idx.c_str());
-                Blob& blob            = this->blobs_[bottom_blob_index];
-                blob.consumer         = i;
-                layer->bottom_[j]     = bottom_blob_index;
+                const pnnx::Operand* operand = this->graph_->ops[i]->inputs[j];
+                int bottom_blob_index        = blob_index_of[operand];
+                Blob& blob                   = this->blobs_[bottom_blob_index];
+                blob.consumers.push_back(i);
+                blob.shape        = operand->shape;
+                layer->bottom_[j] = bottom_blob_index;
             }
 
             layer->top_.resize(top_count);
             for (int j = 0; j < top_count; ++j) {
-                std::string output_idx = this->graph_->ops[i]->outputs[j]->name;
-                std::regex rx("[0-9]+");
-                if (!std::regex_match(output_idx.begin(), output_idx.end(), rx)) {
-                    SIMPLE_LOG_ERROR("create blob failed!, %s layer, %i blob is not number\n",
-                                     this->graph_->ops[i]->name.c_str(),
-                                     output_idx);
-                    ret = MStatus::M_NOT_SUPPORT;
-                    break;
-                }
-                int top_blob_index = std::atoi(output_idx.c_str());
-                Blob& blob         = this->blobs_[top_blob_index];
-                blob.producer      = i;
-                layer->top_[j]     = top_blob_index;
+                const pnnx::Operand* operand = this->graph_->ops[i]->outputs[j];
+                int top_blob_index           = blob_index_of[operand];
+                Blob& blob                   = this->blobs_[top_blob_index];
+                blob.producer                = i;
+                blob.shape                   = operand->shape;
+                layer->top_[j]               = top_blob_index;
+            }
+
+            // graph boundary, pnnx.Input has no bottom and pnnx.Output has no top
+            if (!bottom_count) {
+                input_blob_index_.insert(
+                    input_blob_index_.end(), layer->top_.begin(), layer->top_.end());
+            }
+            if (!top_count) {
+                output_blob_index_.insert(
+                    output_blob_index_.end(), layer->bottom_.begin(), layer->bottom_.end());
             }
 
             // load param to layer
+            ret = layer->Init(this->graph_->ops[i]->params);
+            if (ret != MStatus::M_OK) {
+                SIMPLE_LOG_ERROR("[%s:%s] layer init failed\n", layer_name.c_str(), type.c_str());
+                break;
+            }
+            ret = layer->Load(this->graph_->ops[i]->attrs);
+            if (ret != MStatus::M_OK) {
+                SIMPLE_LOG_ERROR("[%s:%s] layer load failed\n", layer_name.c_str(), type.c_str());
+                break;
+            }
 
             layers_[i] = std::move(layer);
         }
+        if (ret != MStatus::M_OK) {
+            break;
+        }
+
+        ret = InitScratch();
+        if (ret != MStatus::M_OK) {
+            break;
+        }
+
+        ret = BuildNameIndex();
+        if (ret != MStatus::M_OK) {
+            break;
+        }
 
+        ret = CompilePlan();
+        if (ret != MStatus::M_OK) {
+            SIMPLE_LOG_ERROR("Net::CompilePlan failed\n");
+            break;
+        }
+
+        ret = PlanMemory();
+        if (ret != MStatus::M_OK) {
+            SIMPLE_LOG_ERROR("Net::PlanMemory failed\n");
+            break;
+        }
     } while (0);
     SIMPLE_LOG_DEBUG("Net::Init End\n");
     return ret;
 }
 
-MStatus Net::Forward(int layer_index, std::vector<TensorPtr>& blob_mats) const {
-    if (layer_index < static_cast<int>(layers_.size()) || layer_index < 0) {
-        SIMPLE_LOG_ERROR("Net::Forward index out of range, %ivs%i", layer_index, layers_.size());
-        return MStatus::M_OUT_OF_MEMORY;
+MStatus Net::SaveCompiled(const std::string& path) const {
+    if (!graph_ || plan_.empty() || graph_->ops.size() != layers_.size()) {
+        SIMPLE_LOG_ERROR("Net::SaveCompiled needs a net initialized from a pnnx model\n");
+        return MStatus::M_INVALID_ARG;
+    }
+
+    CompiledWriter writer;
+    writer.WriteInt(static_cast<int64_t>(blobs_.size()));
+    for (size_t i = 0; i < blobs_.size(); ++i) {
+        const Blob& blob = blobs_[i];
+        writer.WriteString(blob.name);
+        writer.WriteInt(blob.producer);
+        writer.WriteInts(blob.consumers);
+        writer.WriteInts(blob.shape);
+        writer.WriteInt(layout_->arena_offsets[i]);
+    }
+    writer.WriteInts(input_blob_index_);
+    writer.WriteInts(output_blob_index_);
+    for (const auto* names : {&input_names_, &output_names_}) {
+        writer.WriteInt(static_cast<int64_t>(names->size()));
+        for (const auto& name : *names) {
+            writer.WriteString(name);
+        }
+    }
+
+    // layers in graph order, Init params as the graph optimizer left them and the packed
+    // weights each layer writes itself
+    writer.WriteInt(static_cast<int64_t>(layers_.size()));
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        const pnnx::Operator* op = graph_->ops[i];
+        const Layer* layer       = layers_[i].get();
+        writer.WriteString(op->type);
+        writer.WriteString(layer->name_);
+        writer.WriteInts(layer->bottom_);
+        writer.WriteInts(layer->top_);
+        writer.WriteInt(static_cast<int64_t>(op->params.size()));
+        for (const auto& param : op->params) {
+            writer.WriteString(param.first);
+            writer.WriteParameter(param.second);
+        }
+        MStatus ret = layer->SavePacked(writer);
+        if (ret != MStatus::M_OK) {
+            SIMPLE_LOG_ERROR("Net::SaveCompiled layer %s failed\n", layer->name_.c_str());
+            return ret;
+        }
+    }
+
+    writer.WriteInt(static_cast<int64_t>(plan_.size()));
+    for (const auto& step : plan_) {
+        writer.WriteInt(step.layer_index);
+        writer.WriteInts(step.successors);
+    }
+    writer.WriteInt(static_cast<int64_t>(layout_->arena_size));
+
+    return writer.Save(path, ResolveCpuIsa(option_->cpu_isa), option_->executor_mode);
+}
+
+MStatus Net::LoadCompiled(const std::string& path) {
+    SIMPLE_LOG_DEBUG("Net::LoadCompiled Start\n");
+    MStatus ret = MStatus::M_OK;
+    do {
+        InitThreadPool();
+        graph_.reset();
+        compiled_ = std::make_shared<MappedFile>();
+        if (!compiled_->Open(path) || compiled_->Size() < sizeof(CompiledModelHeader)) {
+            SIMPLE_LOG_ERROR("Net::LoadCompiled map %s failed\n", path.c_str());
+            ret = MStatus::M_INVALID_ARG;
+            break;
+        }
+
+        CompiledModelHeader header;
+        memcpy(&header, compiled_->Data(), sizeof(header));
+        const size_t file_size = compiled_->Size();
+        if (memcmp(header.magic, COMPILED_MODEL_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != COMPILED_MODEL_VERSION || header.meta_offset > file_size ||
+            header.meta_size > file_size - header.meta_offset || header.data_offset > file_size ||
+            header.data_size > file_size - header.data_offset ||
+            header.data_offset % MEMORY_ALIGNMENT) {
+            SIMPLE_LOG_ERROR("Net::LoadCompiled %s is not a compiled model of version %i\n",
+                             path.c_str(),
+                             COMPILED_MODEL_VERSION);
+            ret = MStatus::M_INVALID_ARG;
+            break;
+        }
+        // weight panels only fit the micro kernel they were packed for
+        const CpuIsa isa = ResolveCpuIsa(option_->cpu_isa);
+        if (!kernel::GemmPackedCompatible(static_cast<CpuIsa>(header.cpu_isa), isa)) {
+            SIMPLE_LOG_ERROR("Net::LoadCompiled %s packed for %s, kernels use %s\n",
+                             path.c_str(),
+                             CpuIsaName(static_cast<CpuIsa>(header.cpu_isa)),
+                             CpuIsaName(isa));
+            ret = MStatus::M_NOT_SUPPORT;
+            break;
+        }
+        SIMPLE_LOG_INFO("Net::LoadCompiled kernels use %s\n", CpuIsaName(isa));
+
+        CompiledReader reader(compiled_->Data() + header.meta_offset,
+                              header.meta_size,
+                              compiled_->Data() + header.data_offset,
+                              header.data_size);
+        auto layout = std::make_shared<ShapeLayout>();
+        ret         = LoadCompiledRecords(reader, *layout);
+        if (ret != MStatus::M_OK) {
+            break;
+        }
+        ret = InitScratch();
+        if (ret != MStatus::M_OK) {
+            break;
+        }
+        ret = BuildNameIndex();
+        if (ret != MStatus::M_OK) {
+            break;
+        }
+
+        // arena offsets planned for the sequential order are not safe for concurrent steps
+        int64_t arena_size = 0;
+        if (!reader.ReadInt(arena_size) || arena_size < 0) {
+            SIMPLE_LOG_ERROR("Net::LoadCompiled truncated model\n");
+            ret = MStatus::M_INVALID_ARG;
+            break;
+        }
+        if (option_->executor_mode == ExecutorMode::M_PARALLEL &&
+            header.executor_mode != static_cast<int32_t>(ExecutorMode::M_PARALLEL)) {
+            ret = PlanMemory();
+        } else {
+            layout->arena_size = static_cast<size_t>(arena_size);
+            ret                = BindMemory(layout);
+        }
+    } while (0);
+    if (ret != MStatus::M_OK) {
+        session_.reset();
+        layout_.reset();
+        plan_.clear();
+        layers_.clear();
+        blobs_.clear();
+        compiled_.reset();
     }
+    SIMPLE_LOG_DEBUG("Net::LoadCompiled End\n");
+    return ret;
+}
 
-    auto& layer = layers_[layer_index];
-    for (size_t i = 0; i < layer->bottom_.size(); ++i) {
-        int bottom_index = layer->bottom_[i];
-        auto ret         = Forward(blobs_[bottom_index].producer, blob_mats);
+MStatus Net::LoadCompiledRecords(CompiledReader& reader, ShapeLayout& layout) {
+    auto truncated = [] {
+        SIMPLE_LOG_ERROR("Net::LoadCompiled truncated model\n");
+        return MStatus::M_INVALID_ARG;
+    };
+    auto valid_index = [](const std::vector<int>& indices, size_t count) {
+        for (int index : indices) {
+            if (index < 0 || static_cast<size_t>(index) >= count) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    size_t blob_count = 0;
+    if (!reader.ReadCount(blob_count)) {
+        return truncated();
+    }
+    blobs_.assign(blob_count, Blob());
+    layout.arena_offsets.assign(blob_count, -1);
+    for (size_t i = 0; i < blob_count; ++i) {
+        Blob& blob = blobs_[i];
+        if (!reader.ReadString(blob.name) || !reader.ReadInt(blob.producer) ||
+            !reader.ReadInts(blob.consumers) || !reader.ReadInts(blob.shape) ||
+            !reader.ReadInt(layout.arena_offsets[i])) {
+            return truncated();
+        }
+        layout.shapes.push_back(blob.shape);
+    }
+    if (!reader.ReadInts(input_blob_index_) || !reader.ReadInts(output_blob_index_) ||
+        !valid_index(input_blob_index_, blob_count) ||
+        !valid_index(output_blob_index_, blob_count)) {
+        return truncated();
+    }
+    for (auto* names : {&input_names_, &output_names_}) {
+        size_t count = 0;
+        if (!reader.ReadCount(count) || count > blob_count) {
+            return truncated();
+        }
+        names->resize(count);
+        for (auto& name : *names) {
+            if (!reader.ReadString(name)) {
+                return truncated();
+            }
+        }
+    }
+
+    size_t layer_count = 0;
+    if (!reader.ReadCount(layer_count)) {
+        return truncated();
+    }
+    layers_.assign(layer_count, nullptr);
+    for (size_t i = 0; i < layer_count; ++i) {
+        std::string type;
+        std::string name;
+        std::vector<int> bottoms;
+        std::vector<int> tops;
+        size_t param_count = 0;
+        if (!reader.ReadString(type) || !reader.ReadString(name) || !reader.ReadInts(bottoms) ||
+            !reader.ReadInts(tops) || !valid_index(bottoms, blob_count) ||
+            !valid_index(tops, blob_count) || !reader.ReadCount(param_count)) {
+            return truncated();
+        }
+        std::map<std::string, pnnx::Parameter> params;
+        for (size_t j = 0; j < param_count; ++j) {
+            std::string key;
+            if (!reader.ReadString(key) || !reader.ReadParameter(params[key])) {
+                return truncated();
+            }
+        }
+
+        auto layer_type_ptr = layer_map.find(type);
+        std::shared_ptr<Layer> layer =
+            layer_type_ptr == layer_map.end()
+                ? nullptr
+                : RegisterBase<Layer>::GetInstance().Create(layer_type_ptr->second);
+        if (!layer) {
+            SIMPLE_LOG_ERROR("get [%s:%s] layer failed\n", name.c_str(), type.c_str());
+            return MStatus::M_NOT_SUPPORT;
+        }
+        layer->name_      = name;
+        layer->type_name_ = type;
+        layer->option_    = option_;
+        layer->bottom_    = std::move(bottoms);
+        layer->top_       = std::move(tops);
+        MStatus ret       = layer->Init(params);
+        if (ret == MStatus::M_OK) {
+            ret = layer->LoadPacked(reader);
+        }
         if (ret != MStatus::M_OK) {
-            SIMPLE_LOG_ERROR("Net::Forward failed, layer_name: %s, bottom_index: %i\n",
-                             layer->GetName().c_str(),
-                             bottom_index);
+            SIMPLE_LOG_ERROR("[%s:%s] layer restore failed\n", name.c_str(), type.c_str());
             return ret;
         }
+        layers_[i] = std::move(layer);
+    }
+
+    // producers and consumers index layers, PlanMemory looks their steps up
+    for (const auto& blob : blobs_) {
+        if (blob.producer < -1 || blob.producer >= static_cast<int>(layer_count) ||
+            !valid_index(blob.consumers, layer_count)) {
+            return truncated();
+        }
+    }
+
+    size_t step_count = 0;
+    if (!reader.ReadCount(step_count) || step_count > layer_count) {
+        return truncated();
+    }
+    plan_.assign(step_count, ExecStep());
+    for (size_t i = 0; i < step_count; ++i) {
+        ExecStep& step = plan_[i];
+        // the dependency count is not stored, it is derived from the successors below so a
+        // corrupt file can not stall the parallel executor
+        step.dependency = 0;
+        if (!reader.ReadInt(step.layer_index) || !reader.ReadInts(step.successors) ||
+            step.layer_index < 0 || static_cast<size_t>(step.layer_index) >= layer_count ||
+            !valid_index(step.successors, step_count)) {
+            return truncated();
+        }
+        // steps are stored in topological order, a successor never comes first
+        for (int next : step.successors) {
+            if (static_cast<size_t>(next) <= i) {
+                return truncated();
+            }
+        }
+        step.layer   = layers_[step.layer_index].get();
+        step.bottoms = step.layer->bottom_;
+        step.tops    = step.layer->top_;
+    }
+    for (const auto& step : plan_) {
+        for (int next : step.successors) {
+            ++plan_[next].dependency;
+        }
+    }
+    SIMPLE_LOG_DEBUG("Net::LoadCompiled %i layers, %i steps\n", layer_count, step_count);
+    return MStatus::M_OK;
+}
+
+MStatus Net::CompilePlan() {
+    const int layer_count = static_cast<int>(layers_.size());
+
+    // dependency counters, a layer is ready once every producer of its bottoms has been
+    // scheduled. boundary layers (no bottom or no top) only mark blobs and are not executed
+    std::vector<int> pending(layer_count, 0);
+    std::vector<std::vector<int>> successors(layer_count);
+    for (int i = 0; i < layer_count; ++i) {
+        for (int bottom : layers_[i]->bottom_) {
+            int producer = blobs_[bottom].producer;
+            if (producer < 0) {
+                SIMPLE_LOG_ERROR("blob %i consumed by %s has no producer\n",
+                                 bottom,
+                                 layers_[i]->GetName().c_str());
+                return MStatus::M_INVALID_ARG;
+            }
+            successors[producer].push_back(i);
+            ++pending[i];
+        }
+    }
+
+    // kahn's algorithm, the min-heap keeps pnnx operator order whenever it is already valid
+    std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+    for (int i = 0; i < layer_count; ++i) {
+        if (!pending[i]) {
+            ready.push(i);
+        }
+    }
+
+    plan_.clear();
+    plan_.reserve(layer_count);
+    int visited = 0;
+    while (!ready.empty()) {
+        int index = ready.top();
+        ready.pop();
+        ++visited;
+
+        for (int next : successors[index]) {
+            if (!--pending[next]) {
+                ready.push(next);
+            }
+        }
+
+        const auto& layer = layers_[index];
+        if (layer->bottom_.empty() || layer->top_.empty()) {
+            continue;
+        }
+        ExecStep step;
+        step.layer       = layer.get();
+        step.layer_index = index;
+        step.bottoms     = layer->bottom_;
+        step.tops        = layer->top_;
+        step.dependency  = 0;
+        plan_.emplace_back(std::move(step));
     }
+
+    if (visited != layer_count) {
+        SIMPLE_LOG_ERROR("Net::CompilePlan graph has cycle, %i of %i layers sorted\n",
+                         visited,
+                         layer_count);
+        plan_.clear();
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // step level dependencies for the parallel executor
+    std::vector<int> step_of(layer_count, -1);
+    for (size_t i = 0; i < plan_.size(); ++i) {
+        step_of[plan_[i].layer_index] = static_cast<int>(i);
+    }
+    for (size_t i = 0; i < plan_.size(); ++i) {
+        std::vector<int> producers;
+        for (int bottom : plan_[i].bottoms) {
+            int producer = step_of[blobs_[bottom].producer];
+            if (producer >= 0 &&
+                std::find(producers.begin(), producers.end(), producer) == producers.end()) {
+                producers.push_back(producer);
+                plan_[producer].successors.push_back(static_cast<int>(i));
+            }
+        }
+        plan_[i].dependency = static_cast<int>(producers.size());
+    }
+    SIMPLE_LOG_DEBUG("Net::CompilePlan %i steps\n", plan_.size());
+    return MStatus::M_OK;
 }
 
-int Net::find_blob_index_by_name(const std::string& name) {
-    int index = -1;
+MStatus Net::PlanMemory() {
+    auto layout = std::make_shared<ShapeLayout>();
+    for (const auto& blob : blobs_) {
+        layout->shapes.push_back(blob.shape);
+    }
+    MStatus ret = PlanMemory(*layout);
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+    return BindMemory(layout);
+}
+
+MStatus Net::InferShapes(const std::vector<std::vector<int>>& input_shapes,
+                         ShapeLayout& layout) const {
+    if (input_shapes.size() != input_blob_index_.size()) {
+        SIMPLE_LOG_ERROR("Net::InferShapes expect %i input shapes, got %i\n",
+                         input_blob_index_.size(),
+                         input_shapes.size());
+        return MStatus::M_INVALID_ARG;
+    }
+    layout.shapes.resize(blobs_.size());
+    for (size_t i = 0; i < blobs_.size(); ++i) {
+        layout.shapes[i] = blobs_[i].shape;
+    }
+    for (size_t i = 0; i < input_shapes.size(); ++i) {
+        layout.shapes[input_blob_index_[i]] = input_shapes[i];
+    }
+
+    // the plan is topologically sorted, so the bottoms of a step are known when it is reached
+    std::vector<std::vector<int>> bottoms;
+    std::vector<std::vector<int>> tops;
+    for (const auto& step : plan_) {
+        bottoms.clear();
+        bool fixed = true;
+        for (int bottom : step.bottoms) {
+            bottoms.push_back(layout.shapes[bottom]);
+            fixed = fixed && layout.shapes[bottom] == blobs_[bottom].shape;
+        }
+        MStatus ret = step.layer->InferShape(bottoms, tops);
+        if (ret == MStatus::M_NOT_SUPPORT && fixed) {
+            // the static shapes stay valid for a layer that sees its static inputs
+            continue;
+        }
+        if (ret != MStatus::M_OK || tops.size() != step.tops.size()) {
+            SIMPLE_LOG_ERROR("Net::InferShapes layer %s cannot take the input shapes\n",
+                             step.layer->GetName().c_str());
+            return ret != MStatus::M_OK ? ret : MStatus::M_INTERNAL_FAILED;
+        }
+        for (size_t j = 0; j < tops.size(); ++j) {
+            if (!BlobBytes(tops[j])) {
+                SIMPLE_LOG_ERROR("Net::InferShapes layer %s produces an empty blob\n",
+                                 step.layer->GetName().c_str());
+                return MStatus::M_INVALID_ARG;
+            }
+            layout.shapes[step.tops[j]] = tops[j];
+        }
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Net::PlanMemory(ShapeLayout& layout) const {
+    std::vector<int> step_of(layers_.size(), -1);
+    for (size_t i = 0; i < plan_.size(); ++i) {
+        step_of[plan_[i].layer_index] = static_cast<int>(i);
+    }
+
+    std::vector<bool> external(blobs_.size(), false);
+    for (int index : input_blob_index_) {
+        external[index] = true;
+    }
+    for (int index : output_blob_index_) {
+        external[index] = true;
+    }
+
+    // lifetime of every intermediate blob over the execution order
+    std::vector<MemoryPlanner::Lifetime> lifetimes;
+    size_t total_size = 0;
     for (size_t i = 0; i < blobs_.size(); ++i) {
         const Blob& blob = blobs_[i];
-        if (blob.name == name) {
-            index = static_cast<int>(i);
-            break;
+        if (external[i] || blob.producer < 0 || step_of[blob.producer] < 0) {
+            continue;
+        }
+        MemoryPlanner::Lifetime lifetime;
+        lifetime.blob  = static_cast<int>(i);
+        lifetime.size  = BlobBytes(layout.shapes[i]);
+        lifetime.first = step_of[blob.producer];
+        lifetime.last  = lifetime.first;
+        for (int consumer : blob.consumers) {
+            lifetime.last = std::max(lifetime.last, step_of[consumer]);
+        }
+        if (!lifetime.size) {
+            SIMPLE_LOG_ERROR("Net::PlanMemory blob %i has no static shape\n", i);
+            return MStatus::M_NOT_SUPPORT;
         }
+        total_size += AlignSize(lifetime.size);
+        lifetimes.emplace_back(lifetime);
     }
-    SIMPLE_LOG_DEBUG("Net::find_blob_index_by_name name:%s, index:%i\n", name.c_str(), index);
+    std::vector<size_t> offsets;
+    size_t arena_size = 0;
+    if (option_->executor_mode == ExecutorMode::M_PARALLEL) {
+        // steps run out of plan order, two blobs may only share memory when every step
+        // touching one of them is an ancestor of the step producing the other
+        const size_t words = (plan_.size() + 63) / 64;
+        std::vector<uint64_t> ancestors(plan_.size() * words, 0);
+        for (size_t i = 0; i < plan_.size(); ++i) {
+            uint64_t* cur = ancestors.data() + i * words;
+            for (int succ : plan_[i].successors) {
+                uint64_t* next = ancestors.data() + succ * words;
+                for (size_t w = 0; w < words; ++w) {
+                    next[w] |= cur[w];
+                }
+                next[i / 64] |= 1ULL << (i % 64);
+            }
+        }
+        auto before = [&](size_t a, size_t b) -> bool {
+            const uint64_t* anc = ancestors.data() + lifetimes[b].first * words;
+            const Blob& blob    = blobs_[lifetimes[a].blob];
+            auto is_ancestor    = [&](int step) {
+                return step >= 0 && (anc[step / 64] >> (step % 64)) & 1ULL;
+            };
+            if (!is_ancestor(lifetimes[a].first)) {
+                return false;
+            }
+            for (int consumer : blob.consumers) {
+                if (step_of[consumer] >= 0 && !is_ancestor(step_of[consumer])) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        arena_size = MemoryPlanner().Plan(lifetimes, offsets, [&](size_t a, size_t b) {
+            return !before(a, b) && !before(b, a);
+        });
+    } else {
+        arena_size = MemoryPlanner().Plan(lifetimes, offsets);
+    }
+
+    layout.arena_offsets.assign(blobs_.size(), -1);
+    for (size_t i = 0; i < lifetimes.size(); ++i) {
+        layout.arena_offsets[lifetimes[i].blob] = static_cast<int64_t>(offsets[i]);
+    }
+    layout.arena_size = arena_size;
+
+    SIMPLE_LOG_INFO("Net::PlanMemory %i intermediate blobs, arena %i bytes, unshared %i bytes\n",
+                    lifetimes.size(),
+                    arena_size,
+                    total_size);
+    return MStatus::M_OK;
+}
+
+MStatus Net::SegmentMemory(ShapeLayout& layout) const {
+    const auto& offsets = layout.arena_offsets;
+    if (offsets.size() != blobs_.size() || layout.shapes.size() != blobs_.size()) {
+        SIMPLE_LOG_ERROR("Net::SegmentMemory layout does not match the blobs\n");
+        return MStatus::M_INVALID_ARG;
+    }
+    for (size_t i = 0; i < blobs_.size(); ++i) {
+        if (offsets[i] >= 0 &&
+            static_cast<size_t>(offsets[i]) + BlobBytes(layout.shapes[i]) > layout.arena_size) {
+            SIMPLE_LOG_ERROR("Net::SegmentMemory blob %i outside of the arena\n", i);
+            return MStatus::M_INVALID_ARG;
+        }
+    }
+    for (int index : output_blob_index_) {
+        if (!BlobBytes(layout.shapes[index])) {
+            SIMPLE_LOG_ERROR("Net::SegmentMemory output blob %i has no static shape\n", index);
+            return MStatus::M_NOT_SUPPORT;
+        }
+    }
+
+    // the blob boundaries cut the arena into segments, a blob covers a contiguous run of them
+    // and a session tracks the step that last wrote each one
+    std::vector<int64_t> bounds;
+    for (size_t i = 0; i < blobs_.size(); ++i) {
+        if (offsets[i] >= 0) {
+            bounds.push_back(offsets[i]);
+            bounds.push_back(offsets[i] + static_cast<int64_t>(BlobBytes(layout.shapes[i])));
+        }
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    layout.segment_count = bounds.empty() ? 0 : static_cast<int>(bounds.size()) - 1;
+    layout.blob_segments.assign(blobs_.size(), std::make_pair(0, 0));
+    for (size_t i = 0; i < blobs_.size(); ++i) {
+        if (offsets[i] >= 0) {
+            const int64_t end = offsets[i] + static_cast<int64_t>(BlobBytes(layout.shapes[i]));
+            layout.blob_segments[i].first = static_cast<int>(
+                std::lower_bound(bounds.begin(), bounds.end(), offsets[i]) - bounds.begin());
+            layout.blob_segments[i].second = static_cast<int>(
+                std::lower_bound(bounds.begin(), bounds.end(), end) - bounds.begin());
+        }
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Net::BindMemory(const std::shared_ptr<ShapeLayout>& layout) {
+    MStatus ret = SegmentMemory(*layout);
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+
+    input_slots_.clear();
+    output_slots_.clear();
+    std::vector<bool> is_input(blobs_.size(), false);
+    std::vector<bool> is_output(blobs_.size(), false);
+    for (int index : input_blob_index_) {
+        is_input[index] = true;
+    }
+    for (int index : output_blob_index_) {
+        is_output[index] = true;
+    }
+    blob_step_.assign(blobs_.size(), -1);
+    for (size_t i = 0; i < plan_.size(); ++i) {
+        for (size_t j = 0; j < plan_[i].bottoms.size(); ++j) {
+            if (is_input[plan_[i].bottoms[j]]) {
+                input_slots_.emplace_back(static_cast<int>(i), static_cast<int>(j));
+            }
+            if (is_output[plan_[i].bottoms[j]]) {
+                output_slots_.emplace_back(static_cast<int>(i), static_cast<int>(j));
+            }
+        }
+        for (int top : plan_[i].tops) {
+            blob_step_[top] = static_cast<int>(i);
+        }
+    }
+    layout_ = layout;
+    {
+        std::lock_guard<std::mutex> lck(layout_mutex_);
+        layout_cache_.clear();
+    }
+
+    session_ = std::make_shared<Session>(*this);
+    return session_->Init();
 }
 
-int Net::find_layer_index_by_name(const std::string& name) {
-    int index = -1;
+MStatus Net::GetLayout(const std::vector<std::vector<int>>& input_shapes,
+                       ShapeLayoutPtr& layout) const {
+    auto matches = [&](const ShapeLayoutPtr& candidate) {
+        for (size_t i = 0; i < input_blob_index_.size(); ++i) {
+            if (candidate->shapes[input_blob_index_[i]] != input_shapes[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!layout_ || input_shapes.size() != input_blob_index_.size()) {
+        SIMPLE_LOG_ERROR("Net::GetLayout expect %i input shapes, got %i\n",
+                         input_blob_index_.size(),
+                         input_shapes.size());
+        return MStatus::M_INVALID_ARG;
+    }
+    if (matches(layout_)) {
+        layout = layout_;
+        return MStatus::M_OK;
+    }
+
+    auto lookup = [&]() {
+        for (auto it = layout_cache_.begin(); it != layout_cache_.end(); ++it) {
+            if (matches(*it)) {
+                layout_cache_.splice(layout_cache_.begin(), layout_cache_, it);
+                layout = *it;
+                return true;
+            }
+        }
+        return false;
+    };
+    {
+        std::lock_guard<std::mutex> lck(layout_mutex_);
+        if (lookup()) {
+            return MStatus::M_OK;
+        }
+    }
+
+    // planned without the lock, a session asking for the same shapes meanwhile keeps the
+    // layout that made it into the cache first
+    auto planned = std::make_shared<ShapeLayout>();
+    MStatus ret  = InferShapes(input_shapes, *planned);
+    if (ret == MStatus::M_OK) {
+        ret = PlanMemory(*planned);
+    }
+    if (ret == MStatus::M_OK) {
+        ret = SegmentMemory(*planned);
+    }
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+
+    std::lock_guard<std::mutex> lck(layout_mutex_);
+    if (lookup()) {
+        return MStatus::M_OK;
+    }
+    layout = planned;
+    layout_cache_.push_front(layout);
+    const size_t capacity = static_cast<size_t>(std::max(1, option_->shape_cache_size));
+    while (layout_cache_.size() > capacity) {
+        layout_cache_.pop_back();
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Net::SetInput(size_t idx, const TensorPtr& tensor) {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::SetInput net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->SetInput(idx, tensor);
+}
+
+MStatus Net::SetInput(const std::string& name, const TensorPtr& tensor) {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::SetInput net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->SetInput(name, tensor);
+}
+
+MStatus Net::SetOutput(size_t idx, const TensorPtr& tensor) {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::SetOutput net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->SetOutput(idx, tensor);
+}
+
+MStatus Net::SetOutput(const std::string& name, const TensorPtr& tensor) {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::SetOutput net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->SetOutput(name, tensor);
+}
+
+MStatus Net::GetOutput(const std::string& name, TensorPtr& tensor) const {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::GetOutput net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->GetOutput(name, tensor);
+}
+
+bool Net::IsBoundOutput(const TensorPtr& tensor) const {
+    return session_ && session_->IsBoundOutput(tensor);
+}
+
+MStatus Net::Reshape(const std::vector<std::vector<int>>& shapes) {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::Reshape net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->Reshape(shapes);
+}
+
+const std::vector<int>& Net::GetCurrentInputShape(size_t idx) const {
+    return session_ ? session_->GetInputShape(idx) : GetInputShape(idx);
+}
+
+const std::vector<int>& Net::GetCurrentOutputShape(size_t idx) const {
+    return session_ ? session_->GetOutputShape(idx) : GetOutputShape(idx);
+}
+
+int Net::GetInputIndex(const std::string& name) const {
+    auto it = input_index_.find(name);
+    return it == input_index_.end() ? -1 : it->second;
+}
+
+int Net::GetOutputIndex(const std::string& name) const {
+    auto it = output_index_.find(name);
+    return it == output_index_.end() ? -1 : it->second;
+}
+
+MStatus Net::Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output) {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::Forward net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->Forward(input, output);
+}
+
+MStatus Net::Forward() {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::Forward net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->Forward();
+}
+
+MStatus Net::Extract(const std::string& name, TensorPtr& tensor) {
+    if (!session_) {
+        SIMPLE_LOG_ERROR("Net::Extract net %s is not initialized\n", net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return session_->Extract(name, tensor);
+}
+
+MStatus Net::BuildNameIndex() {
+    blob_index_.clear();
+    blob_index_.reserve(blobs_.size());
+    for (size_t i = 0; i < blobs_.size(); ++i) {
+        if (!blob_index_.emplace(blobs_[i].name, static_cast<int>(i)).second) {
+            SIMPLE_LOG_ERROR("Net blob name %s is not unique\n", blobs_[i].name.c_str());
+            return MStatus::M_INVALID_ARG;
+        }
+    }
+    layer_index_.clear();
+    layer_index_.reserve(layers_.size());
     for (size_t i = 0; i < layers_.size(); ++i) {
-        const auto& layer = layers_[i];
-        if (layers_[i]->GetName() == name) {
-            index = static_cast<int>(i);
-            break;
+        if (!layer_index_.emplace(layers_[i]->GetName(), static_cast<int>(i)).second) {
+            SIMPLE_LOG_ERROR("Net layer name %s is not unique\n", layers_[i]->GetName().c_str());
+            return MStatus::M_INVALID_ARG;
         }
     }
+
+    // graph inputs and outputs answer to their pnnx.Input/pnnx.Output op and to their blob
+    auto index_io = [this](const std::vector<std::string>& names,
+                           const std::vector<int>& blob_index,
+                           std::unordered_map<std::string, int>& io_index) {
+        io_index.clear();
+        for (size_t i = 0; i < blob_index.size(); ++i) {
+            if (i < names.size()) {
+                io_index.emplace(names[i], static_cast<int>(i));
+            }
+            io_index.emplace(blobs_[blob_index[i]].name, static_cast<int>(i));
+        }
+    };
+    index_io(input_names_, input_blob_index_, input_index_);
+    index_io(output_names_, output_blob_index_, output_index_);
+    return MStatus::M_OK;
+}
+
+int Net::find_blob_index_by_name(const std::string& name) const {
+    auto it   = blob_index_.find(name);
+    int index = it == blob_index_.end() ? -1 : it->second;
+    SIMPLE_LOG_DEBUG("Net::find_blob_index_by_name name:%s, index:%i\n", name.c_str(), index);
+    return index;
+}
+
+int Net::find_layer_index_by_name(const std::string& name) const {
+    auto it   = layer_index_.find(name);
+    int index = it == layer_index_.end() ? -1 : it->second;
     SIMPLE_LOG_DEBUG("Net::find_layer_index_by_name name:%s, index:%i\n", name.c_str(), index);
+    return index;
 }
 } // namespace nn
@@ -3,55 +3,189 @@
 
 #include "runtime/blob.h"
 #include "runtime/layer.h"
+#include "runtime/mat.h"
 #include "runtime/net_option.h"
 #include "runtime/pnnx/ir.h"
+#include "utils/aligned_buffer.h"
+#include "utils/mapped_file.h"
 
-#include <bitset>
+#include <list>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <tensor/tensor.h>
 
 namespace nn {
-constexpr int16_t MAX_NUM_LAYER = 2048;
-
+class CompiledReader;
 class Layer;
+class Session;
 class Net {
 public:
     using TensorPtr = std::shared_ptr<base::Tensor>;
 
 public:
-    Net(const std::string& name = "");
+    Net(const std::string& name = "", const std::shared_ptr<NetOption>& option = nullptr);
     ~Net() = default;
 
     MStatus Init(const std::string& param, const std::string& bin);
 
-    // MStatus Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output);
+    /// @brief write the initialized net as a compiled model, the execution plan, arena offsets
+    /// and kernel ready weights in one 64 byte aligned file tied to the isa of the kernels
+    MStatus SaveCompiled(const std::string& path) const;
+
+    /// @brief init from a file written by SaveCompiled in place of Init, the file is mapped and
+    /// the weights are used in place, fails when it was packed for an isa running another
+    /// gemm kernel
+    MStatus LoadCompiled(const std::string& path);
+
+    MStatus Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output);
 
-    MStatus Forward(int layer_index, std::vector<TensorPtr>& blob_mats) const;
+    /// @brief SetInput, SetOutput, Forward, GetOutput, Extract and IsBoundOutput of the session
+    /// owned by the net, concurrent callers each create their own Session on the net instead
+    MStatus SetInput(const std::string& name, const TensorPtr& tensor);
+    MStatus SetInput(size_t idx, const TensorPtr& tensor);
+    MStatus SetOutput(const std::string& name, const TensorPtr& tensor);
+    MStatus SetOutput(size_t idx, const TensorPtr& tensor);
+    MStatus Forward();
+    MStatus GetOutput(const std::string& name, TensorPtr& tensor) const;
+    MStatus Extract(const std::string& name, TensorPtr& tensor);
+    bool IsBoundOutput(const TensorPtr& tensor) const;
+
+    /// @brief Reshape of the session owned by the net, see Session::Reshape
+    MStatus Reshape(const std::vector<std::vector<int>>& shapes);
 
     const std::string Summary() const;
 
+    size_t GetInputNum() const { return input_blob_index_.size(); }
+    size_t GetOutputNum() const { return output_blob_index_.size(); }
+
+    const std::string& GetInputName(size_t idx) const { return input_names_[idx]; }
+    const std::string& GetOutputName(size_t idx) const { return output_names_[idx]; }
+
+    /// @return position of the named graph input/output, -1 when there is none
+    int GetInputIndex(const std::string& name) const;
+    int GetOutputIndex(const std::string& name) const;
+
+    /// @brief static shape of the idx-th graph input/output as exported by pnnx
+    const std::vector<int>& GetInputShape(size_t idx) const {
+        return blobs_[input_blob_index_[idx]].shape;
+    }
+    const std::vector<int>& GetOutputShape(size_t idx) const {
+        return blobs_[output_blob_index_[idx]].shape;
+    }
+
+    /// @brief shape the session owned by the net runs the idx-th graph input/output with
+    const std::vector<int>& GetCurrentInputShape(size_t idx) const;
+    const std::vector<int>& GetCurrentOutputShape(size_t idx) const;
+
+    /// @brief peak activation memory in bytes of the static shapes, the size of the
+    /// intermediate blob arena every session allocates for them
+    size_t GetWorkspaceSize() const { return layout_ ? layout_->arena_size : 0; }
+
+    /// @brief op type Init failed on with M_NOT_SUPPORT because no layer implements it, empty
+    /// when Init did not fail that way. tells a model the runtime can not run yet from one
+    /// that is broken
+    const std::string& GetUnsupportedOp() const { return unsupported_op_; }
+
+private:
+    // one entry of the compiled execution plan, blobs are resolved to slot indices
+    struct ExecStep {
+        Layer* layer;
+        int layer_index;
+        std::vector<int> bottoms;
+        std::vector<int> tops;
+        // steps consuming a top of this step, and the number of distinct producer steps
+        std::vector<int> successors;
+        int dependency;
+    };
+
+    // blob shapes of one input shape signature and the arena plan derived from them, never
+    // changed once built so sessions share it without locking
+    struct ShapeLayout {
+        std::vector<std::vector<int>> shapes;
+        // byte offset of every blob inside the arena of a session, -1 for graph inputs and
+        // outputs
+        std::vector<int64_t> arena_offsets;
+        size_t arena_size{0};
+        // [first, last) arena segment of every blob, blobs sharing a segment share memory
+        std::vector<std::pair<int, int>> blob_segments;
+        int segment_count{0};
+    };
+    using ShapeLayoutPtr = std::shared_ptr<const ShapeLayout>;
+
 private:
+    friend class Session;
+
     Net(const Net&);
     Net& operator=(const Net&);
 
-    int find_blob_index_by_name(const std::string& name);
-    int find_layer_index_by_name(const std::string& name);
+    void InitThreadPool();
+    // one ScratchPool sized for the layers needing scratch, shared by all of them
+    MStatus InitScratch();
+    MStatus LoadCompiledRecords(CompiledReader& reader, ShapeLayout& layout);
+
+    MStatus CompilePlan();
+    // plan the static shapes and bind the session owned by the net
+    MStatus PlanMemory();
+    // propagate input shapes through the plan into layout.shapes
+    MStatus InferShapes(const std::vector<std::vector<int>>& input_shapes,
+                        ShapeLayout& layout) const;
+    // arena offsets and size of the intermediate blobs of layout.shapes
+    MStatus PlanMemory(ShapeLayout& layout) const;
+    // check the arena offsets of layout against its size and cut the arena into segments
+    MStatus SegmentMemory(ShapeLayout& layout) const;
+    // make layout the static one and bind the session owned by the net
+    MStatus BindMemory(const std::shared_ptr<ShapeLayout>& layout);
+    // layout of the given input shapes, planned on first use and cached
+    MStatus GetLayout(const std::vector<std::vector<int>>& input_shapes,
+                      ShapeLayoutPtr& layout) const;
+
+    // name lookups of blobs, layers and graph inputs/outputs, built after the layers exist
+    MStatus BuildNameIndex();
+    int find_blob_index_by_name(const std::string& name) const;
+    int find_layer_index_by_name(const std::string& name) const;
 
 private:
     std::string net_name_;
     std::shared_ptr<NetOption> option_{nullptr};
 
     std::unique_ptr<pnnx::Graph> graph_{nullptr};
+    // compiled model the layer weights point into after LoadCompiled
+    std::shared_ptr<MappedFile> compiled_{nullptr};
 
     std::vector<Blob> blobs_;
+    // blob index by operand name
+    std::unordered_map<std::string, int> blob_index_;
     std::vector<std::shared_ptr<Layer>> layers_;
-    std::bitset<MAX_NUM_LAYER> state_;
+    std::unordered_map<std::string, int> layer_index_;
+
+    // topologically sorted layers, built once in Init
+    std::vector<ExecStep> plan_;
+
+    // layout of the static shapes, every session starts with it
+    ShapeLayoutPtr layout_{nullptr};
+    // layouts of other input shapes, most recently used first, shared by every session
+    mutable std::mutex layout_mutex_;
+    mutable std::list<ShapeLayoutPtr> layout_cache_;
+    // (step, bottom slot) pairs reading a graph input, rebound by every SetInput
+    std::vector<std::pair<int, int>> input_slots_;
+    // (step, bottom slot) pairs reading a graph output, rebound by every SetOutput
+    std::vector<std::pair<int, int>> output_slots_;
+    // plan step producing every blob, -1 for graph inputs
+    std::vector<int> blob_step_;
+
+    std::shared_ptr<Session> session_{nullptr};
 
     std::vector<int> input_blob_index_;
     std::vector<int> output_blob_index_;
 
     std::vector<std::string> input_names_;
     std::vector<std::string> output_names_;
+    // see GetUnsupportedOp
+    std::string unsupported_op_;
+    // position in input_blob_index_/output_blob_index_ by op or blob name
+    std::unordered_map<std::string, int> input_index_;
+    std::unordered_map<std::string, int> output_index_;
 };
 } // namespace nn
 
@@ -1,6 +1,69 @@
 #ifndef SIMPLE_NN_NET_OPTION_H_
 #define SIMPLE_NN_NET_OPTION_H_
+
+#include "runtime/cpu.h"
+#include "runtime/profiler.h"
+#include "runtime/thread_pool.h"
+
+#include <memory>
+#include <vector>
+
 namespace nn {
-class NetOption {};
+enum class ExecutorMode {
+    // run the execution plan in order on the calling thread
+    M_SEQUENTIAL,
+    // run independent layers concurrently on the thread pool
+    M_PARALLEL,
+};
+
+enum class ConvAlgorithm {
+    // pick per layer from a cost model of the layer shape
+    M_AUTO,
+    // im2col gemm for every convolution
+    M_IM2COL_GEMM,
+    // winograd F(4x4, 3x3) for every 3x3 stride 1 convolution it applies to
+    M_WINOGRAD,
+};
+
+class NetOption {
+public:
+    NetOption()  = default;
+    ~NetOption() = default;
+
+public:
+    ExecutorMode executor_mode{ExecutorMode::M_SEQUENTIAL};
+
+    // threads of the pool created by the net when thread_pool is not set, calling thread included
+    int num_threads{1};
+
+    // busy wait iterations before an idle pool thread sleeps
+    int spin_count{20000};
+
+    // cpu ids the pool workers are pinned to, empty leaves scheduling to the os
+    std::vector<int> cpu_affinity{};
+
+    // kernel level of the layers, M_AUTO picks the best one of the host at Init
+    CpuIsa cpu_isa{CpuIsa::M_AUTO};
+
+    // convolution algorithm, decided once per layer when the weights are loaded
+    ConvAlgorithm conv_algorithm{ConvAlgorithm::M_AUTO};
+
+    // map the bin file instead of reading it, weights the layers use in place are then shared
+    // through the page cache by every net loading the same model
+    bool use_mmap{true};
+
+    // input shape signatures other than the static one whose memory plan the net keeps, and
+    // whose arena every session keeps, the least recently used one is dropped first
+    int shape_cache_size{4};
+
+    // pool used for inter and intra operator parallelism, nets given the same pool share
+    // its workers instead of each spawning their own. every thread calling into the nets
+    // runs pool tasks as well, so concurrent callers add to the pool's thread count
+    std::shared_ptr<ThreadPool> thread_pool{nullptr};
+
+    // records every layer run of the nets given this option when set, left null the layers
+    // run untimed
+    std::shared_ptr<Profiler> profiler{nullptr};
+};
 } // namespace nn
-#endif // SIMPLE_NN_NET_OPTION_H_
\ No newline at end of file
+#endif // SIMPLE_NN_NET_OPTION_H_
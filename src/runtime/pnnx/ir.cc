@@ -22,6 +22,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <string>
+#include <unordered_map>
 
 #if BUILD_PNNX
 #include <torch/csrc/api/include/torch/version.h>
@@ -522,16 +523,16 @@ std::vector<float> Attribute::get_float32_data() const {
     std::vector<float> v(elemcount());
 
     if (type == 1) {
-        memcpy((void*)v.data(), (const void*)data.data(), data.size());
+        memcpy((void*)v.data(), (const void*)bytes(), bytesize());
     } else if (type == 2) {
         // f64
-        const double* p = (const double*)data.data();
+        const double* p = (const double*)bytes();
         for (size_t i = 0; i < v.size(); i++) {
             v[i] = float(p[i]);
         }
     } else if (type == 3) {
         // f16
-        const unsigned short* p = (const unsigned short*)data.data();
+        const unsigned short* p = (const unsigned short*)bytes();
         for (size_t i = 0; i < v.size(); i++) {
             // v[i] = float16_to_float32(p[i]);
         }
@@ -543,6 +544,11 @@ std::vector<float> Attribute::get_float32_data() const {
 }
 
 void Attribute::set_float32_data(const std::vector<float>& newdata) {
+    // the mapping is read only, new data is always owned
+    view      = nullptr;
+    view_size = 0;
+    mapping.reset();
+
     data.resize(newdata.size() * elemsize());
 
     if (type == 1) {
@@ -574,7 +580,8 @@ bool operator==(const Attribute& lhs, const Attribute& rhs) {
     if (lhs.shape != rhs.shape)
         return false;
 
-    if (lhs.data != rhs.data)
+    if (lhs.bytesize() != rhs.bytesize() ||
+        memcmp(lhs.bytes(), rhs.bytes(), lhs.bytesize()) != 0)
         return false;
 
     return true;
@@ -604,9 +611,9 @@ Attribute operator+(const Attribute& a, const Attribute& b) {
     c.shape = a.shape;
     c.shape[0] += b.shape[0]; // concat the first dim
 
-    c.data.resize(a.data.size() + b.data.size());
-    memcpy(c.data.data(), a.data.data(), a.data.size());
-    memcpy(c.data.data() + a.data.size(), b.data.data(), b.data.size());
+    c.data.resize(a.bytesize() + b.bytesize());
+    memcpy(c.data.data(), a.bytes(), a.bytesize());
+    memcpy(c.data.data() + a.bytesize(), b.bytes(), b.bytesize());
 
     return c;
 }
@@ -842,30 +849,33 @@ static void load_shape(Operator* op, const std::string& key, const std::string&
     }
 }
 
-static void load_attribute(Operator* op,
-                           const std::string& key,
-                           const std::string& value,
-                           StoreZipReader& szr) {
+// @name=(1024,512)f32, the shape is decoded in place with the same cursor as parse_shape
+static void parse_attribute(Operator* op,
+                            const char* kb,
+                            const char* ke,
+                            const char* b,
+                            const char* e,
+                            StoreZipReader& szr) {
+    std::string key(kb, ke);
     Attribute& a = op->attrs[key];
 
+    const char* close = e;
+    while (close > b && *(close - 1) != ')')
+        close--;
+
     // type
-    std::string typestr = value.substr(value.find_last_of(')') + 1);
-    a.type              = string_to_type(typestr.c_str());
+    a.type = string_to_type(std::string(close, e).c_str());
 
     if (a.type == 0)
         return;
 
     // shape
-    std::string lc = value.substr(1, value.find_last_of(')') - 1);
-    std::istringstream lcss(lc);
-
     a.shape.clear();
-    while (!lcss.eof()) {
-        std::string elem;
-        std::getline(lcss, elem, ',');
-
-        int i = std::stoi(elem);
-        a.shape.push_back(i);
+    const char* last = close - 1;
+    for (const char* eb = b + 1; eb < last;) {
+        const char* ee = std::find(eb, last, ',');
+        a.shape.push_back((int)strtol(eb, 0, 10));
+        eb = ee + 1;
     }
 
     if (a.shape.empty())
@@ -892,97 +902,294 @@ static void load_attribute(Operator* op,
         fprintf(stderr, "file size not match expect %lu but got %lu\n", bytesize, filesize);
     }
 
+    const char* view = szr.file_data(filename);
+    if (view && filesize == bytesize) {
+        a.view      = view;
+        a.view_size = filesize;
+        a.mapping   = szr.mapping();
+        return;
+    }
+
     a.data.resize(bytesize);
     szr.read_file(filename, (char*)a.data.data());
 }
 
-int Graph::load(const std::string& parampath, const std::string& binpath) {
-    std::ifstream is(parampath, std::ios::in | std::ios::binary);
-    if (!is.good()) {
-        fprintf(stderr, "open failed\n");
-        return -1;
+// cursor over the param file held in one buffer, tokens are [begin, end) ranges into it so
+// a line is parsed without copying it or any token that is not stored in the graph
+struct param_cursor {
+    const char* p;
+    const char* end;
+
+    // skip blanks up to the next token of the current line, false at the end of the line
+    bool skip_blank() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+        return p < end && *p != '\n';
+    }
+
+    void next_line() {
+        while (p < end && *p != '\n')
+            p++;
+        if (p < end)
+            p++;
+    }
+
+    bool token(const char*& b, const char*& e) {
+        if (!skip_blank())
+            return false;
+        b = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+            p++;
+        e = p;
+        return true;
     }
 
-    StoreZipReader szr;
-    if (szr.open(binpath) != 0) {
-        fprintf(stderr, "open failed\n");
-        return -1;
+    int integer() {
+        const char* b;
+        const char* e;
+        if (!token(b, e))
+            return 0;
+        return (int)strtol(b, 0, 10);
     }
+};
 
-    int magic = 0;
-    {
-        std::string line;
-        std::getline(is, line);
-        std::istringstream iss(line);
+static bool is_string_token(const char* b, const char* e) {
+    if (b == e)
+        return true;
+    if (b[0] == '-')
+        return b + 1 == e || b[1] < '0' || b[1] > '9';
+    return b[0] < '0' || b[0] > '9';
+}
 
-        iss >> magic;
+static bool is_float_token(const char* b, const char* e) {
+    for (const char* c = b; c < e; c++) {
+        if (*c == '.' || *c == 'e')
+            return true;
     }
+    return false;
+}
 
-    int operator_count = 0;
-    int operand_count  = 0;
+// same result as Parameter::parse_from_string on std::string(b, e)
+static Parameter parse_parameter(const char* b, const char* e) {
+    Parameter p;
+    p.type = 0;
+
+    if (std::find(b, e, '%') != e) {
+        p.type = 4;
+        p.s.assign(b, e);
+        return p;
+    }
+
+    const size_t len = e - b;
+    if (len == 0 || (len == 4 && memcmp(b, "None", 4) == 0) ||
+        (len == 2 && (memcmp(b, "()", 2) == 0 || memcmp(b, "[]", 2) == 0))) {
+        return p;
+    }
+
+    if ((len == 4 && memcmp(b, "True", 4) == 0) || (len == 5 && memcmp(b, "False", 5) == 0)) {
+        p.type = 1;
+        p.b    = len == 4;
+        return p;
+    }
+
+    if (b[0] == '(' || b[0] == '[') {
+        // list, elements end at ',' or the closing bracket which strtol and strtof stop at
+        const char* last = e - 1;
+        for (const char* eb = b + 1; eb <= last;) {
+            const char* ee = std::find(eb, last, ',');
+            if (is_string_token(eb, ee)) {
+                p.type = 7;
+                p.as.push_back(std::string(eb, ee));
+            } else if (is_float_token(eb, ee)) {
+                p.type = 6;
+                p.af.push_back(strtof(eb, 0));
+            } else {
+                p.type = 5;
+                p.ai.push_back((int)strtol(eb, 0, 10));
+            }
+            eb = ee + 1;
+        }
+        return p;
+    }
+
+    if (is_string_token(b, e)) {
+        p.type = 4;
+        p.s.assign(b, e);
+        return p;
+    }
+
+    if (is_float_token(b, e)) {
+        p.type = 3;
+        p.f    = strtof(b, 0);
+        return p;
+    }
+
+    p.type = 2;
+    p.i    = (int)strtol(b, 0, 10);
+    return p;
+}
+
+// #name=(1,3,?,%w)f32, same as load_shape without the string copies
+static void
+parse_shape(Operator* op, const char* kb, const char* ke, const char* b, const char* e) {
+    Operand* operand = 0;
+    for (int k = 0; k < 2 && !operand; k++) {
+        for (Operand* r : k == 0 ? op->inputs : op->outputs) {
+            if (r->name.size() == (size_t)(ke - kb) && memcmp(r->name.data(), kb, ke - kb) == 0) {
+                operand = r;
+                break;
+            }
+        }
+    }
+
+    if (!operand) {
+        fprintf(stderr,
+                "no such operand %s for operator %s\n",
+                std::string(kb, ke).c_str(),
+                op->name.c_str());
+        return;
+    }
+
+    const char* close = e;
+    while (close > b && *(close - 1) != ')')
+        close--;
+    if (close == b || *b != '(') {
+        fprintf(stderr,
+                "bad shape %s for operator %s\n",
+                std::string(b, e).c_str(),
+                op->name.c_str());
+        return;
+    }
+
+    // type
+    operand->type = string_to_type(std::string(close, e).c_str());
+
+    // shape
+    operand->shape.clear();
+    const char* last = close - 1;
+    for (const char* eb = b + 1; eb < last;) {
+        const char* ee = std::find(eb, last, ',');
+        if (ee - eb == 1 && *eb == '?') {
+            operand->shape.push_back(-1);
+        } else if (*eb == '%') {
+            // encode %abc as symbolic tag
+            operand->shape.push_back(-233);
+            int index = operand->shape.size() - 1;
+            operand->params[std::string("__shape_") + std::to_string(index)] =
+                std::string(eb + 1, ee);
+        } else {
+            operand->shape.push_back((int)strtol(eb, 0, 10));
+        }
+        eb = ee + 1;
+    }
+}
+
+int Graph::load(const std::string& parampath, const std::string& binpath, bool use_mmap) {
+    // the whole param file in one read, nul terminated so strtol and strtof stop at the end
+    std::vector<char> buffer;
     {
-        std::string line;
-        std::getline(is, line);
-        std::istringstream iss(line);
+        FILE* fp = fopen(parampath.c_str(), "rb");
+        if (!fp) {
+            fprintf(stderr, "open failed\n");
+            return -1;
+        }
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        buffer.resize(size > 0 ? size + 1 : 1, '\0');
+        size_t nread = size > 0 ? fread(buffer.data(), 1, size, fp) : 0;
+        fclose(fp);
+        if (size < 0 || nread != (size_t)size) {
+            fprintf(stderr, "read %s failed\n", parampath.c_str());
+            return -1;
+        }
+    }
 
-        iss >> operator_count >> operand_count;
+    StoreZipReader szr;
+    if (szr.open(binpath, use_mmap) != 0) {
+        fprintf(stderr, "open failed\n");
+        return -1;
     }
 
-    for (int i = 0; i < operator_count; i++) {
-        std::string line;
-        std::getline(is, line);
-        std::istringstream iss(line);
+    param_cursor cur = {buffer.data(), buffer.data() + buffer.size() - 1};
 
-        std::string type;
-        std::string name;
-        int input_count  = 0;
-        int output_count = 0;
+    int magic = cur.integer();
+    (void)magic;
+    cur.next_line();
 
-        iss >> type >> name >> input_count >> output_count;
+    int operator_count = cur.integer();
+    int operand_count  = cur.integer();
+    cur.next_line();
 
-        Operator* op = new_operator(type, name);
+    ops.reserve(ops.size() + operator_count);
+    operands.reserve(operands.size() + operand_count);
 
-        for (int j = 0; j < input_count; j++) {
-            std::string operand_name;
-            iss >> operand_name;
+    // operands by name, get_operand scans the whole list
+    std::unordered_map<std::string, Operand*> operand_index;
+    operand_index.reserve(operand_count);
+    for (Operand* r : operands)
+        operand_index[r->name] = r;
 
-            Operand* r = get_operand(operand_name);
+    std::string name_buffer;
+    for (int i = 0; i < operator_count && cur.p < cur.end; i++, cur.next_line()) {
+        const char* b;
+        const char* e;
+        if (!cur.token(b, e)) {
+            // tolerate blank lines the same way the stream reader did
+            continue;
+        }
+        std::string type(b, e);
+        std::string name;
+        if (cur.token(b, e))
+            name.assign(b, e);
+        int input_count  = cur.integer();
+        int output_count = cur.integer();
+
+        Operator* op = new_operator(type, name);
+        op->inputs.reserve(input_count);
+        op->outputs.reserve(output_count);
+
+        for (int j = 0; j < input_count && cur.token(b, e); j++) {
+            name_buffer.assign(b, e);
+            auto it    = operand_index.find(name_buffer);
+            Operand* r = it != operand_index.end() ? it->second : 0;
+            if (!r) {
+                fprintf(stderr,
+                        "no such operand %s for operator %s\n",
+                        name_buffer.c_str(),
+                        op->name.c_str());
+                return -1;
+            }
             r->consumers.push_back(op);
             op->inputs.push_back(r);
         }
 
-        for (int j = 0; j < output_count; j++) {
-            std::string operand_name;
-            iss >> operand_name;
-
-            Operand* r  = new_operand(operand_name);
+        for (int j = 0; j < output_count && cur.token(b, e); j++) {
+            Operand* r  = new_operand(std::string(b, e));
             r->producer = op;
             op->outputs.push_back(r);
+            operand_index[r->name] = r;
         }
 
         // key=value
-        while (!iss.eof()) {
-            std::string param;
-            iss >> param;
-
-            std::string key;
-            std::string value;
-            std::istringstream pss(param);
-            std::getline(pss, key, '=');
-            std::getline(pss, value);
+        while (cur.token(b, e)) {
+            const char* eq = std::find(b, e, '=');
+            const char* vb = eq < e ? eq + 1 : e;
+            if (b == eq)
+                continue;
 
-            if (key[0] == '@') {
+            if (*b == '@') {
                 // attribute
-                load_attribute(op, key.substr(1), value, szr);
-            } else if (key[0] == '$') {
+                parse_attribute(op, b + 1, eq, vb, e, szr);
+            } else if (*b == '$') {
                 // operand input key
-                load_input_key(op, key.substr(1), value);
-            } else if (key[0] == '#') {
+                load_input_key(op, std::string(b + 1, eq), std::string(vb, e));
+            } else if (*b == '#') {
                 // operand shape
-                load_shape(op, key.substr(1), value);
+                parse_shape(op, b + 1, eq, vb, e);
             } else {
                 // parameter
-                load_parameter(op, key, value);
+                op->params[std::string(b, eq)] = parse_parameter(vb, e);
             }
         }
     }
@@ -1048,7 +1255,7 @@ int Graph::save(const std::string& parampath, const std::string& binpath) {
             fprintf(paramfp, "%s", type_to_string(attr.type));
 
             std::string filename = op->name + "." + it.first;
-            szw.write_file(filename, attr.data.data(), attr.data.size());
+            szw.write_file(filename, attr.bytes(), attr.bytesize());
         }
 
         if (op->inputnames.size() == op->inputs.size()) {
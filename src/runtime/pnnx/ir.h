@@ -20,6 +20,7 @@
 #include <limits.h>
 #include <limits>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -146,12 +147,22 @@ public:
     std::vector<float> get_float32_data() const;
     void set_float32_data(const std::vector<float>& data);
 
+    // raw bytes, the mapped view when there is one and data otherwise
+    const char* bytes() const { return view ? view : data.data(); }
+    size_t bytesize() const { return view ? view_size : data.size(); }
+
     // 0=null 1=f32 2=f64 3=f16 4=i32 5=i64 6=i16 7=i8 8=u8 9=bool 10=c64 11=c128 12=c32
     int type;
     std::vector<int> shape;
 
     std::vector<char> data;
 
+    // zero copy view into a memory mapped weight file, data stays empty while it is set
+    // and mapping keeps the file mapped for as long as any attribute points into it
+    const char* view = nullptr;
+    size_t view_size = 0;
+    std::shared_ptr<const void> mapping;
+
     std::map<std::string, Parameter> params;
 };
 
@@ -205,7 +216,8 @@ public:
     Graph();
     ~Graph();
 
-    int load(const std::string& parampath, const std::string& binpath);
+    // use_mmap maps the bin file and leaves the attributes as views into it
+    int load(const std::string& parampath, const std::string& binpath, bool use_mmap = false);
     int save(const std::string& parampath, const std::string& binpath);
 
     int python(const std::string& pypath, const std::string& binpath);
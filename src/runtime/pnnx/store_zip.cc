@@ -13,9 +13,11 @@
 // specific language governing permissions and limitations under the License.
 
 #include "runtime/pnnx/store_zip.h"
+#include "utils/mapped_file.h"
 #include <map>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <string>
 #include <vector>
 
@@ -70,6 +72,9 @@ PACK(struct end_of_central_directory_record {
     uint16_t comment_length;
 });
 
+// alignment of the stored file data in archives written by StoreZipWriter
+static const size_t STORE_ZIP_ALIGNMENT = 64;
+
 static uint32_t CRC32_TABLE[256];
 
 static void CRC32_TABLE_INIT() {
@@ -99,22 +104,45 @@ static uint32_t CRC32_buffer(const unsigned char* data, int len) {
 }
 
 StoreZipReader::StoreZipReader() {
-    fp = 0;
+    fp        = 0;
+    map_data  = 0;
+    data_size = 0;
 }
 
 StoreZipReader::~StoreZipReader() {
     close();
 }
 
-int StoreZipReader::open(const std::string& path) {
+int StoreZipReader::open(const std::string& path, bool use_mmap) {
     close();
 
+#if !defined(_WIN32)
+    if (use_mmap) {
+        map = std::make_shared<nn::MappedFile>();
+        if (map->Open(path)) {
+            map_data  = (const char*)map->Data();
+            data_size = map->Size();
+        } else {
+            fprintf(stderr, "mmap %s failed, fall back to read\n", path.c_str());
+            map.reset();
+        }
+    }
+#endif
+
     fp = fopen(path.c_str(), "rb");
     if (!fp) {
         fprintf(stderr, "open failed\n");
         return -1;
     }
 
+    // stored files are checked against the mapping or the file, a truncated archive must not
+    // hand out data past its end
+    if (!map_data) {
+        fseek(fp, 0, SEEK_END);
+        data_size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+    }
+
     while (!feof(fp)) {
         // peek signature
         uint32_t signature;
@@ -155,6 +183,16 @@ int StoreZipReader::open(const std::string& path) {
             fm.offset = ftell(fp);
             fm.size   = lfh.compressed_size;
 
+            if (fm.offset > data_size || fm.size > data_size - fm.offset) {
+                fprintf(stderr,
+                        "%s runs past the end of the archive, %zu + %zu > %zu\n",
+                        name.c_str(),
+                        fm.offset,
+                        fm.size,
+                        data_size);
+                return -1;
+            }
+
             filemetas[name] = fm;
 
             //             fprintf(stderr, "%s = %d  %d\n", name.c_str(), fm.offset, fm.size);
@@ -208,14 +246,54 @@ int StoreZipReader::read_file(const std::string& name, char* data) {
     size_t offset = filemetas[name].offset;
     size_t size   = filemetas[name].size;
 
+    if (offset > data_size || size > data_size - offset) {
+        fprintf(stderr, "%s runs past the end of the archive\n", name.c_str());
+        return -1;
+    }
+
+    if (map_data) {
+        memcpy(data, map_data + offset, size);
+        return 0;
+    }
+
     fseek(fp, offset, SEEK_SET);
-    if (fread(data, size, 1, fp) != -1) {
+    if (size && fread(data, size, 1, fp) != 1) {
+        fprintf(stderr, "read %s failed\n", name.c_str());
+        return -1;
     }
 
     return 0;
 }
 
+const char* StoreZipReader::file_data(const std::string& name) const {
+    if (!map_data)
+        return 0;
+
+    auto it = filemetas.find(name);
+    if (it == filemetas.end())
+        return 0;
+
+    if (it->second.offset > data_size || it->second.size > data_size - it->second.offset)
+        return 0;
+
+    return map_data + it->second.offset;
+}
+
+std::shared_ptr<const void> StoreZipReader::mapping() const {
+    // views share ownership of the mapping, not of the reader
+    if (!map)
+        return nullptr;
+
+    return std::shared_ptr<const void>(map, map->Data());
+}
+
 int StoreZipReader::close() {
+    // views handed out keep their own reference to the mapping
+    map_data  = 0;
+    data_size = 0;
+    map.reset();
+    filemetas.clear();
+
     if (!fp)
         return 0;
 
@@ -267,10 +345,19 @@ int StoreZipWriter::write_file(const std::string& name, const char* data, size_t
     lfh.file_name_length   = name.size();
     lfh.extra_field_length = 0;
 
+    // pad the extra field so the stored data starts on an alignment boundary, readers that map
+    // the archive can then use weights in place
+    size_t data_offset     = offset + sizeof(signature) + sizeof(lfh) + name.size();
+    lfh.extra_field_length = (STORE_ZIP_ALIGNMENT - data_offset % STORE_ZIP_ALIGNMENT) %
+                             STORE_ZIP_ALIGNMENT;
+
     fwrite((char*)&lfh, sizeof(lfh), 1, fp);
 
     fwrite((char*)name.c_str(), name.size(), 1, fp);
 
+    static const char padding[STORE_ZIP_ALIGNMENT] = {0};
+    fwrite(padding, lfh.extra_field_length, 1, fp);
+
     fwrite(data, size, 1, fp);
 
     StoreZipMeta szm;
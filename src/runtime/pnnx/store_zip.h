@@ -17,9 +17,14 @@
 
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+namespace nn {
+class MappedFile;
+} // namespace nn
+
 namespace pnnx {
 
 class StoreZipReader {
@@ -27,17 +32,30 @@ public:
     StoreZipReader();
     ~StoreZipReader();
 
-    int open(const std::string& path);
+    // use_mmap maps the whole archive read only so file_data can hand out views into it,
+    // falls back to plain reads when the file can not be mapped
+    int open(const std::string& path, bool use_mmap = false);
 
     size_t get_file_size(const std::string& name);
 
     int read_file(const std::string& name, char* data);
 
+    // start of the stored file inside the mapping, null when not mapped or no such file
+    const char* file_data(const std::string& name) const;
+
+    // owner of the mapping, it stays mapped until the last copy is released
+    std::shared_ptr<const void> mapping() const;
+
     int close();
 
 private:
     FILE* fp;
 
+    const char* map_data;
+    std::shared_ptr<nn::MappedFile> map;
+    // length of the mapping, or of the file when it is read
+    size_t data_size;
+
     struct StoreZipMeta {
         size_t offset;
         size_t size;
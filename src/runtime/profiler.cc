@@ -0,0 +1,182 @@
+#include "runtime/profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <log.h>
+#include <sstream>
+
+namespace nn {
+namespace {
+const char NET_EVENT_TYPE[] = "net";
+
+// json string body, names come from the model file
+std::string EscapeJson(const std::string& str) {
+    std::string out;
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+} // namespace
+
+Profiler::Profiler(size_t max_events) : start_(Clock::now()), max_events_(max_events) {}
+
+void Profiler::Record(Event event, Clock::time_point begin, Clock::time_point end) {
+    event.begin_us    = std::chrono::duration<double, std::micro>(begin - start_).count();
+    event.duration_us = std::chrono::duration<double, std::micro>(end - begin).count();
+
+    std::lock_guard<std::mutex> lck(mutex_);
+    auto thread = thread_ids_.emplace(std::this_thread::get_id(),
+                                      static_cast<int>(thread_ids_.size()));
+    event.thread_id = thread.first->second;
+
+    if (event.type == NET_EVENT_TYPE) {
+        net_count_++;
+        net_total_us_ += event.duration_us;
+    } else {
+        auto index = stats_index_.emplace(event.name, stats_.size());
+        if (index.second) {
+            stats_.emplace_back();
+            stats_.back().name   = event.name;
+            stats_.back().type   = event.type;
+            stats_.back().min_us = event.duration_us;
+        }
+        LayerStats& stats = stats_[index.first->second];
+        stats.count++;
+        stats.total_us += event.duration_us;
+        stats.min_us = std::min(stats.min_us, event.duration_us);
+        stats.max_us = std::max(stats.max_us, event.duration_us);
+        stats.bytes += event.bytes_read + event.bytes_written;
+        stats.flops += event.flops;
+    }
+
+    if (events_.size() < max_events_) {
+        events_.emplace_back(std::move(event));
+    } else {
+        dropped_++;
+    }
+}
+
+void Profiler::Clear() {
+    std::lock_guard<std::mutex> lck(mutex_);
+    events_.clear();
+    dropped_ = 0;
+    stats_.clear();
+    stats_index_.clear();
+    net_count_    = 0;
+    net_total_us_ = 0;
+}
+
+std::vector<Profiler::Event> Profiler::GetEvents() const {
+    std::lock_guard<std::mutex> lck(mutex_);
+    return events_;
+}
+
+std::vector<Profiler::LayerStats> Profiler::GetLayerStats() const {
+    std::vector<LayerStats> stats;
+    {
+        std::lock_guard<std::mutex> lck(mutex_);
+        stats = stats_;
+    }
+    std::stable_sort(stats.begin(), stats.end(), [](const LayerStats& a, const LayerStats& b) {
+        return a.total_us > b.total_us;
+    });
+    return stats;
+}
+
+std::string Profiler::ChromeTrace() const {
+    std::vector<Event> events = GetEvents();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        const double gflops =
+            event.duration_us > 0 ? event.flops / event.duration_us * 1e-3 : 0.0;
+        ss << (i ? ",\n" : "\n") << "{\"name\":\"" << EscapeJson(event.name) << "\",\"cat\":\""
+           << EscapeJson(event.type) << "\",\"ph\":\"X\",\"ts\":" << event.begin_us
+           << ",\"dur\":" << event.duration_us << ",\"pid\":0,\"tid\":" << event.thread_id
+           << ",\"args\":{\"bytes_read\":" << event.bytes_read
+           << ",\"bytes_written\":" << event.bytes_written << ",\"flops\":" << event.flops
+           << ",\"gflops_per_s\":" << gflops << "}}";
+    }
+    ss << "\n]}\n";
+    return ss.str();
+}
+
+MStatus Profiler::SaveChromeTrace(const std::string& path) const {
+    const std::string trace = ChromeTrace();
+    FILE* fp                = fopen(path.c_str(), "wb");
+    if (!fp) {
+        SIMPLE_LOG_ERROR("Profiler::SaveChromeTrace open %s failed\n", path.c_str());
+        return MStatus::M_FAILED;
+    }
+    bool ok = fwrite(trace.data(), trace.size(), 1, fp) == 1;
+    if (fclose(fp) != 0 || !ok) {
+        SIMPLE_LOG_ERROR("Profiler::SaveChromeTrace write %s failed\n", path.c_str());
+        return MStatus::M_FAILED;
+    }
+    return MStatus::M_OK;
+}
+
+std::string Profiler::Summary(size_t top_n) const {
+    std::vector<LayerStats> stats = GetLayerStats();
+    uint64_t net_count = 0;
+    double net_total   = 0;
+    uint64_t dropped   = 0;
+    {
+        std::lock_guard<std::mutex> lck(mutex_);
+        net_count = net_count_;
+        net_total = net_total_us_;
+        dropped   = dropped_;
+    }
+    double layer_total = 0;
+    for (const auto& item : stats) {
+        layer_total += item.total_us;
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "forward runs " << net_count << ", avg "
+       << (net_count ? net_total / net_count : 0.0) << " us, layer time " << layer_total
+       << " us";
+    if (dropped) {
+        ss << ", " << dropped << " events not kept for the trace";
+    }
+    ss << std::endl
+       << "----------------------------------------------------------------------------"
+          "-----------------------------------"
+       << std::endl
+       << std::left << std::setw(25) << "name" << std::setw(18) << "type" << std::right
+       << std::setw(8) << "count" << std::setw(12) << "total_ms" << std::setw(8) << "%"
+       << std::setw(12) << "avg_us" << std::setw(12) << "min_us" << std::setw(12) << "max_us"
+       << std::setw(10) << "GB/s" << std::setw(10) << "GFLOP/s" << std::endl
+       << "============================================================================"
+          "==================================="
+       << std::endl;
+    const size_t rows = top_n ? std::min(top_n, stats.size()) : stats.size();
+    for (size_t i = 0; i < rows; ++i) {
+        const LayerStats& item = stats[i];
+        const double total     = item.total_us > 0 ? item.total_us : 1.0;
+        ss << std::left << std::setw(25) << item.name << std::setw(18) << item.type
+           << std::right << std::setw(8) << item.count << std::setw(12) << item.total_us * 1e-3
+           << std::setw(8) << (layer_total > 0 ? item.total_us / layer_total * 100.0 : 0.0)
+           << std::setw(12) << item.total_us / item.count << std::setw(12) << item.min_us
+           << std::setw(12) << item.max_us << std::setw(10) << item.bytes / total * 1e-3
+           << std::setw(10) << item.flops / total * 1e-3 << std::endl;
+    }
+    ss << "============================================================================"
+          "===================================";
+    return ss.str();
+}
+} // namespace nn
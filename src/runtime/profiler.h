@@ -0,0 +1,96 @@
+#ifndef SIMPLE_NN_PROFILER_H_
+#define SIMPLE_NN_PROFILER_H_
+
+#include <common.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace nn {
+/// @brief runtime profiler, records every layer run and every Forward of the sessions of the
+/// nets whose NetOption points to it. the per layer totals are kept across runs for Summary,
+/// the single events feed a chrome://tracing file. nets without a profiler only test a null
+/// pointer per layer
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        std::string name;
+        // pnnx op type of a layer, "net" for a whole Forward
+        std::string type;
+        // start since the profiler was created and duration, in microseconds
+        double begin_us{0};
+        double duration_us{0};
+        // small id of the thread that ran it, in order of first appearance
+        int thread_id{0};
+        // activation memory, the weights are not counted
+        uint64_t bytes_read{0};
+        uint64_t bytes_written{0};
+        uint64_t flops{0};
+    };
+
+    /// @brief totals of one layer over every recorded run
+    struct LayerStats {
+        std::string name;
+        std::string type;
+        uint64_t count{0};
+        double total_us{0};
+        double min_us{0};
+        double max_us{0};
+        uint64_t bytes{0};
+        uint64_t flops{0};
+    };
+
+public:
+    /// @param max_events single events kept for the trace, later ones are only counted in
+    /// the totals
+    explicit Profiler(size_t max_events = 1 << 20);
+    ~Profiler() = default;
+
+    /// @brief add an event that ran from begin to end on the calling thread, thread safe
+    void Record(Event event, Clock::time_point begin, Clock::time_point end);
+
+    /// @brief drop every event and total
+    void Clear();
+
+    std::vector<Event> GetEvents() const;
+
+    /// @brief per layer totals, most expensive first
+    std::vector<LayerStats> GetLayerStats() const;
+
+    /// @brief the events in the chrome trace event format, load it in chrome://tracing or
+    /// ui.perfetto.dev
+    std::string ChromeTrace() const;
+    MStatus SaveChromeTrace(const std::string& path) const;
+
+    /// @brief table of the top_n layers by total time with their share, average latency,
+    /// bandwidth and GFLOP/s, 0 lists every layer
+    std::string Summary(size_t top_n = 10) const;
+
+private:
+    Profiler(const Profiler&);
+    Profiler& operator=(const Profiler&);
+
+private:
+    const Clock::time_point start_;
+    const size_t max_events_;
+
+    mutable std::mutex mutex_;
+    std::vector<Event> events_;
+    uint64_t dropped_{0};
+    // whole Forward runs
+    uint64_t net_count_{0};
+    double net_total_us_{0};
+    // totals by layer name, in order of first appearance
+    std::vector<LayerStats> stats_;
+    std::unordered_map<std::string, size_t> stats_index_;
+    std::unordered_map<std::thread::id, int> thread_ids_;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_PROFILER_H_
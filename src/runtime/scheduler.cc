@@ -0,0 +1,313 @@
+#include "runtime/scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <log.h>
+
+namespace nn {
+namespace {
+std::future<Scheduler::Result> FailedResult(MStatus status) {
+    std::promise<Scheduler::Result> promise;
+    Scheduler::Result result;
+    result.status = status;
+    promise.set_value(std::move(result));
+    return promise.get_future();
+}
+
+size_t ShapeCount(const std::vector<int>& shape) {
+    size_t count = 1;
+    for (int dim : shape) {
+        count *= static_cast<size_t>(dim);
+    }
+    return count;
+}
+} // namespace
+
+Scheduler::Scheduler(const std::shared_ptr<Net>& net, const SchedulerOption& option)
+    : net_(net), option_(option) {}
+
+Scheduler::~Scheduler() {
+    Stop();
+}
+
+MStatus Scheduler::Init() {
+    if (!net_ || !net_->GetInputNum() || !net_->GetOutputNum()) {
+        SIMPLE_LOG_ERROR("Scheduler::Init net is not initialized\n");
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // every input and output must be batched along the same leading dimension
+    const int batch = net_->GetInputShape(0).empty() ? 0 : net_->GetInputShape(0)[0];
+    auto sample_size = [batch](const std::vector<int>& shape, std::vector<size_t>& sizes) {
+        if (batch <= 0 || shape.empty() || shape[0] != batch) {
+            return false;
+        }
+        sizes.push_back(ShapeCount(shape) / batch);
+        return true;
+    };
+    input_sizes_.clear();
+    output_sizes_.clear();
+    for (size_t i = 0; i < net_->GetInputNum(); ++i) {
+        if (!sample_size(net_->GetInputShape(i), input_sizes_)) {
+            SIMPLE_LOG_ERROR("Scheduler::Init input %i has no batch dimension of %i\n", i, batch);
+            return MStatus::M_NOT_SUPPORT;
+        }
+    }
+    for (size_t i = 0; i < net_->GetOutputNum(); ++i) {
+        if (!sample_size(net_->GetOutputShape(i), output_sizes_)) {
+            SIMPLE_LOG_ERROR("Scheduler::Init output %i has no batch dimension of %i\n", i, batch);
+            return MStatus::M_NOT_SUPPORT;
+        }
+    }
+    max_batch_size_ = option_.max_batch_size > 0 ? std::min(option_.max_batch_size, batch) : batch;
+
+    std::vector<SchedulerClassOption> class_options = option_.classes;
+    if (class_options.empty()) {
+        class_options.emplace_back();
+    }
+    // a queue of promises cannot be copied, so the classes are never relocated
+    classes_ = std::vector<Class>(class_options.size());
+    for (size_t i = 0; i < classes_.size(); ++i) {
+        int max_batch_size = max_batch_size_;
+        if (class_options[i].max_batch_size > 0) {
+            max_batch_size = std::min(class_options[i].max_batch_size, max_batch_size_);
+        }
+        int delay_us = option_.max_queue_delay_us;
+        if (class_options[i].max_queue_delay_us >= 0) {
+            delay_us = class_options[i].max_queue_delay_us;
+        }
+        classes_[i].max_batch_size  = static_cast<size_t>(max_batch_size);
+        classes_[i].max_queue_delay = std::chrono::microseconds(std::max(0, delay_us));
+    }
+    queued_ = 0;
+
+    {
+        std::lock_guard<std::mutex> lck(mutex_);
+        stop_ = false;
+    }
+    const int num_workers = std::max(1, option_.num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->session.reset(new Session(*net_));
+        MStatus ret = worker->session->Init();
+        if (ret != MStatus::M_OK) {
+            Stop();
+            return ret;
+        }
+        for (size_t j = 0; j < net_->GetInputNum(); ++j) {
+            const auto& shape = net_->GetInputShape(j);
+            worker->inputs.emplace_back(
+                std::make_shared<base::Tensor>(std::vector<uint32_t>(shape.begin(), shape.end()),
+                                               M_LAYOUT_NCHW,
+                                               M_MEM_ON_CPU,
+                                               M_DATA_TYPE_FLOAT32));
+        }
+        worker->thread = std::thread(&Scheduler::WorkerLoop, this, worker.get());
+        workers_.emplace_back(std::move(worker));
+    }
+    SIMPLE_LOG_INFO("Scheduler::Init max batch %i, max delay %i us, %i workers, %i classes\n",
+                    max_batch_size_,
+                    option_.max_queue_delay_us,
+                    num_workers,
+                    classes_.size());
+    return MStatus::M_OK;
+}
+
+std::future<Scheduler::Result>
+Scheduler::Submit(const std::vector<TensorPtr>& inputs, int priority, int64_t timeout_us) {
+    if (priority < 0 || priority >= static_cast<int>(classes_.size())) {
+        SIMPLE_LOG_ERROR("Scheduler::Submit priority %i out of range\n", priority);
+        return FailedResult(MStatus::M_INVALID_ARG);
+    }
+    if (inputs.size() != input_sizes_.size()) {
+        SIMPLE_LOG_ERROR("Scheduler::Submit input size mismatch, %ivs%i\n",
+                         inputs.size(),
+                         input_sizes_.size());
+        return FailedResult(MStatus::M_INVALID_ARG);
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        size_t count = 0;
+        if (inputs[i] && inputs[i]->GetData<float>()) {
+            count = 1;
+            for (auto dim : inputs[i]->GetShape()) {
+                count *= dim;
+            }
+        }
+        if (count != input_sizes_[i]) {
+            SIMPLE_LOG_ERROR("Scheduler::Submit input %i size mismatch, %ivs%i\n",
+                             i,
+                             count,
+                             input_sizes_[i]);
+            return FailedResult(MStatus::M_INVALID_ARG);
+        }
+    }
+
+    Request request;
+    request.inputs  = inputs;
+    request.arrival = Clock::now();
+    if (timeout_us > 0) {
+        request.deadline = request.arrival + std::chrono::microseconds(timeout_us);
+    }
+    auto future = request.promise.get_future();
+    {
+        std::lock_guard<std::mutex> lck(mutex_);
+        if (stop_) {
+            SIMPLE_LOG_ERROR("Scheduler::Submit scheduler is not running\n");
+            return FailedResult(MStatus::M_FAILED);
+        }
+        Class& cls = classes_[priority];
+        cls.queue.emplace_back(std::move(request));
+        cls.stats.submitted++;
+        cls.stats.max_queue_depth = std::max(cls.stats.max_queue_depth, cls.queue.size());
+        queued_++;
+    }
+    cond_.notify_one();
+    return future;
+}
+
+void Scheduler::Stop() {
+    {
+        std::lock_guard<std::mutex> lck(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    workers_.clear();
+}
+
+std::vector<SchedulerClassStats> Scheduler::GetStats() const {
+    std::lock_guard<std::mutex> lck(mutex_);
+    std::vector<SchedulerClassStats> stats;
+    for (const auto& cls : classes_) {
+        stats.push_back(cls.stats);
+        stats.back().queue_depth = cls.queue.size();
+    }
+    return stats;
+}
+
+void Scheduler::WorkerLoop(Worker* worker) {
+    std::vector<Request> batch;
+    while (NextBatch(batch)) {
+        RunBatch(worker, batch);
+        batch.clear();
+    }
+}
+
+bool Scheduler::NextBatch(std::vector<Request>& batch) {
+    std::unique_lock<std::mutex> lck(mutex_);
+    for (;;) {
+        cond_.wait(lck, [this] { return stop_ || queued_; });
+        const auto now = Clock::now();
+        DropExpired(now);
+        if (!queued_) {
+            if (stop_) {
+                return false;
+            }
+            continue;
+        }
+
+        // a class is due once it has a full batch or its oldest request waited long enough,
+        // stopping drains everything. another worker may take the queues meanwhile, so every
+        // wake up starts over
+        bool due  = stop_;
+        auto wake = Clock::time_point::max();
+        for (size_t i = 0; i < classes_.size() && !due; ++i) {
+            const Class& cls = classes_[i];
+            if (cls.queue.empty()) {
+                continue;
+            }
+            const auto ready = cls.queue.front().arrival + cls.max_queue_delay;
+            due              = cls.queue.size() >= cls.max_batch_size || now >= ready;
+            wake             = std::min(wake, ready);
+        }
+        if (!due) {
+            cond_.wait_until(lck, wake);
+            continue;
+        }
+
+        for (auto& cls : classes_) {
+            TakeRequests(cls, now, batch);
+        }
+        // the rest may already form a batch for an idle worker
+        if (queued_) {
+            cond_.notify_one();
+        }
+        if (!batch.empty()) {
+            return true;
+        }
+    }
+}
+
+void Scheduler::Expire(Class& cls, Request& request) {
+    Result result;
+    result.status  = MStatus::M_FAILED;
+    result.expired = true;
+    request.promise.set_value(std::move(result));
+    cls.stats.expired++;
+}
+
+void Scheduler::DropExpired(Clock::time_point now) {
+    // requests of a class usually share a timeout, so the expired ones sit at the front, the
+    // rest are caught when they are taken
+    for (auto& cls : classes_) {
+        while (!cls.queue.empty() && cls.queue.front().deadline <= now) {
+            Expire(cls, cls.queue.front());
+            cls.queue.pop_front();
+            queued_--;
+        }
+    }
+}
+
+void Scheduler::TakeRequests(Class& cls, Clock::time_point now, std::vector<Request>& batch) {
+    while (!cls.queue.empty() && batch.size() < static_cast<size_t>(max_batch_size_)) {
+        Request& request = cls.queue.front();
+        if (request.deadline <= now) {
+            Expire(cls, request);
+        } else {
+            const uint64_t wait_us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(now - request.arrival)
+                    .count());
+            cls.stats.dispatched++;
+            cls.stats.total_wait_us += wait_us;
+            cls.stats.max_wait_us = std::max(cls.stats.max_wait_us, wait_us);
+            batch.emplace_back(std::move(request));
+        }
+        cls.queue.pop_front();
+        queued_--;
+    }
+}
+
+void Scheduler::RunBatch(Worker* worker, std::vector<Request>& batch) {
+    for (size_t i = 0; i < input_sizes_.size(); ++i) {
+        float* data = worker->inputs[i]->GetData<float>();
+        for (size_t j = 0; j < batch.size(); ++j) {
+            memcpy(data + j * input_sizes_[i],
+                   batch[j].inputs[i]->GetData<float>(),
+                   input_sizes_[i] * sizeof(float));
+        }
+    }
+
+    std::vector<TensorPtr> outputs;
+    MStatus ret = worker->session->Forward(worker->inputs, outputs);
+    for (size_t j = 0; j < batch.size(); ++j) {
+        Result result;
+        result.status = ret;
+        for (size_t i = 0; i < outputs.size() && ret == MStatus::M_OK; ++i) {
+            std::vector<uint32_t> shape = outputs[i]->GetShape();
+            shape[0]                    = 1;
+            auto tensor                 = std::make_shared<base::Tensor>(
+                shape, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+            tensor->SetName(outputs[i]->GetName());
+            memcpy(tensor->GetData<float>(),
+                   outputs[i]->GetData<float>() + j * output_sizes_[i],
+                   output_sizes_[i] * sizeof(float));
+            result.outputs.emplace_back(std::move(tensor));
+        }
+        batch[j].promise.set_value(std::move(result));
+    }
+}
+} // namespace nn
@@ -2,16 +2,176 @@
 #define SIMPLE_NN_SCHEDULER_H_
 
 #include "runtime/net.h"
+#include "runtime/session.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace nn {
+/// @brief batching policy of one priority class, unset fields fall back to SchedulerOption
+class SchedulerClassOption {
+public:
+    SchedulerClassOption()  = default;
+    ~SchedulerClassOption() = default;
+
+public:
+    // queued requests of this class that make a batch due, 0 means the max batch size of the
+    // scheduler. the batch itself is filled up to that size from every class
+    int max_batch_size{0};
+
+    // longest the oldest queued request of this class waits, negative means max_queue_delay_us
+    int max_queue_delay_us{-1};
+};
+
+class SchedulerOption {
+public:
+    SchedulerOption()  = default;
+    ~SchedulerOption() = default;
+
+public:
+    // requests coalesced into one forward, 0 or anything above the batch dimension of the net
+    // inputs means the full batch dimension
+    int max_batch_size{0};
+
+    // longest the oldest queued request waits for more before a partial batch runs, 0 runs
+    // whatever is queued right away
+    int max_queue_delay_us{1000};
+
+    // batches in flight at once, each worker runs its own Session on the shared net
+    int num_workers{1};
+
+    // priority classes, class 0 is served first, empty means a single class with the policy
+    // above
+    std::vector<SchedulerClassOption> classes;
+};
+
+/// @brief counters of one priority class since Init
+struct SchedulerClassStats {
+    uint64_t submitted{0};
+    // requests taken into a batch
+    uint64_t dispatched{0};
+    // requests whose deadline passed while queued, they never ran
+    uint64_t expired{0};
+    size_t queue_depth{0};
+    size_t max_queue_depth{0};
+    // time from submit until the batch holding the request was taken off the queue
+    uint64_t total_wait_us{0};
+    uint64_t max_wait_us{0};
+};
+
+/// @brief dynamic batcher in front of a Net whose inputs and outputs share a leading batch
+/// dimension. callers submit single requests and get a future, the scheduler coalesces queued
+/// requests up to max_batch_size or until the oldest one waited max_queue_delay_us, runs one
+/// batched forward and scatters the output rows back. a partial batch still runs the static
+/// batch of the net, the unused rows are ignored.
+/// requests carry a priority class and an optional deadline. every class decides on its own
+/// policy when a batch is due, the batch is then filled from the queues in priority order so
+/// urgent requests never wait behind bulk ones, and requests past their deadline are dropped
+/// without running. a busy high priority class starves the lower ones by design
 class Scheduler {
 public:
-    Scheduler()  = default;
-    ~Scheduler() = default;
+    using TensorPtr = Net::TensorPtr;
+
+    /// @brief outcome of one request, outputs are in net output order with a batch of 1
+    struct Result {
+        MStatus status{MStatus::M_OK};
+        // the deadline passed before the request ran, status is M_FAILED
+        bool expired{false};
+        std::vector<TensorPtr> outputs;
+    };
+
+public:
+    explicit Scheduler(const std::shared_ptr<Net>& net,
+                       const SchedulerOption& option = SchedulerOption());
+    /// @brief stops the workers, requests still queued are run first
+    ~Scheduler();
+
+    /// @brief check the net shapes and start the workers, the net must be initialized
+    MStatus Init();
+
+    /// @brief queue one request
+    /// @param inputs one tensor per net input holding a single sample, read when the batch
+    /// is assembled so they must not change until the future is ready
+    /// @param priority class index into SchedulerOption::classes, 0 is the most urgent
+    /// @param timeout_us the request is dropped if it has not run this long after submit, 0
+    /// waits forever
+    std::future<Result>
+    Submit(const std::vector<TensorPtr>& inputs, int priority = 0, int64_t timeout_us = 0);
+
+    /// @brief run what is queued, then stop the workers, later submits fail
+    void Stop();
+
+    int GetMaxBatchSize() const { return max_batch_size_; }
+
+    size_t GetClassNum() const { return classes_.size(); }
+
+    /// @brief snapshot of the counters of every priority class
+    std::vector<SchedulerClassStats> GetStats() const;
+
+private:
+    Scheduler(const Scheduler&);
+    Scheduler& operator=(const Scheduler&);
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        std::vector<TensorPtr> inputs;
+        std::promise<Result> promise;
+        Clock::time_point arrival;
+        Clock::time_point deadline{Clock::time_point::max()};
+    };
+
+    // resolved policy and queue of one priority class
+    struct Class {
+        size_t max_batch_size{0};
+        std::chrono::microseconds max_queue_delay{0};
+        std::deque<Request> queue;
+        SchedulerClassStats stats;
+    };
+
+    struct Worker {
+        std::unique_ptr<Session> session;
+        // batched inputs the requests are gathered into
+        std::vector<TensorPtr> inputs;
+        std::thread thread;
+    };
+
+    void WorkerLoop(Worker* worker);
+    // block until a batch is due, false once stopped and drained
+    bool NextBatch(std::vector<Request>& batch);
+    void Expire(Class& cls, Request& request);
+    // fail the expired requests at the front of every queue
+    void DropExpired(Clock::time_point now);
+    // move requests of a class into batch until it holds max_batch_size_, the expired ones
+    // are dropped on the way
+    void TakeRequests(Class& cls, Clock::time_point now, std::vector<Request>& batch);
+    void RunBatch(Worker* worker, std::vector<Request>& batch);
 
 private:
     std::shared_ptr<Net> net_{nullptr};
+    SchedulerOption option_;
+    int max_batch_size_{0};
+
+    // floats of one sample of every input and output
+    std::vector<size_t> input_sizes_;
+    std::vector<size_t> output_sizes_;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<Class> classes_;
+    size_t queued_{0};
+    // set until Init starts the workers and again by Stop
+    bool stop_{true};
 };
 } // namespace nn
 
-#endif // SIMPLE_NN_SCHEDULER_H_
\ No newline at end of file
+#endif // SIMPLE_NN_SCHEDULER_H_
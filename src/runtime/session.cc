@@ -0,0 +1,676 @@
+#include "runtime/session.h"
+
+#include <algorithm>
+#include <cstring>
+#include <log.h>
+
+namespace nn {
+namespace {
+size_t ShapeCount(const std::vector<int>& shape) {
+    size_t count = 1;
+    for (int dim : shape) {
+        count *= static_cast<size_t>(dim);
+    }
+    return count;
+}
+
+size_t TensorCount(const Session::TensorPtr& tensor) {
+    size_t count = 1;
+    for (auto dim : tensor->GetShape()) {
+        count *= dim;
+    }
+    return count;
+}
+
+// dims of tensor as a shape of the given rank, trailing 1 beyond the rank are dropped
+bool TensorShape(const Session::TensorPtr& tensor, size_t rank, std::vector<int>& shape) {
+    std::vector<uint32_t> dims = tensor->GetShape();
+    while (dims.size() > rank && dims.back() == 1) {
+        dims.pop_back();
+    }
+    if (dims.size() != rank) {
+        return false;
+    }
+    shape.clear();
+    for (auto dim : dims) {
+        if (!dim) {
+            return false;
+        }
+        shape.push_back(static_cast<int>(dim));
+    }
+    return true;
+}
+} // namespace
+
+Session::Session(const Net& net) : net_(net) {}
+
+MStatus Session::Init() {
+    if (net_.layers_.empty() || !net_.layout_) {
+        SIMPLE_LOG_ERROR("Session::Init net %s is not initialized\n", net_.net_name_.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    input_tensors_.assign(net_.input_blob_index_.size(), nullptr);
+    bound_outputs_.assign(net_.output_blob_index_.size(), nullptr);
+    input_shapes_.clear();
+    for (int index : net_.input_blob_index_) {
+        input_shapes_.push_back(net_.layout_->shapes[index]);
+    }
+    reshape_pending_ = false;
+    bindings_.clear();
+    layout_.reset();
+
+    const auto& plan = net_.plan_;
+    pending_.reset(new std::atomic<int>[plan.size()]);
+    computed_.assign(plan.size(), 0);
+    generation_ = 1;
+    return Activate(net_.layout_);
+}
+
+MStatus Session::Activate(const Net::ShapeLayoutPtr& layout) {
+    if (layout == layout_) {
+        return MStatus::M_OK;
+    }
+
+    // the bound outputs must fit the new shapes before anything switches, a failed rebind
+    // halfway would leave layout_ switched and later runs writing past the caller buffers
+    for (size_t i = 0; i < bound_outputs_.size(); ++i) {
+        if (!bound_outputs_[i]) {
+            continue;
+        }
+        const size_t count = ShapeCount(layout->shapes[net_.output_blob_index_[i]]);
+        if (TensorCount(bound_outputs_[i]) != count) {
+            SIMPLE_LOG_ERROR("Session::Activate bound output %i size mismatch, %ivs%i\n",
+                             i,
+                             TensorCount(bound_outputs_[i]),
+                             count);
+            return MStatus::M_INVALID_ARG;
+        }
+    }
+
+    Binding binding;
+    auto parked = std::find_if(bindings_.begin(), bindings_.end(), [&](const Binding& item) {
+        return item.layout == layout;
+    });
+    if (parked != bindings_.end()) {
+        binding = std::move(*parked);
+        bindings_.erase(parked);
+    } else {
+        if (!binding.arena.Resize(layout->arena_size)) {
+            SIMPLE_LOG_ERROR("Session::Activate alloc %i bytes failed\n", layout->arena_size);
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+        binding.layout = layout;
+        binding.blob_mats.assign(net_.blobs_.size(), Mat());
+        for (size_t i = 0; i < net_.blobs_.size(); ++i) {
+            if (layout->arena_offsets[i] >= 0) {
+                binding.blob_mats[i] = Mat(
+                    reinterpret_cast<float*>(binding.arena.Data() + layout->arena_offsets[i]),
+                    layout->shapes[i]);
+            }
+        }
+        for (int index : net_.output_blob_index_) {
+            const auto& shape = layout->shapes[index];
+            auto tensor       = std::make_shared<base::Tensor>(
+                std::vector<uint32_t>(shape.begin(), shape.end()),
+                M_LAYOUT_NCHW,
+                M_MEM_ON_CPU,
+                M_DATA_TYPE_FLOAT32);
+            tensor->SetName(net_.blobs_[index].name);
+            binding.blob_mats[index] = Mat(tensor->GetData<float>(), shape);
+            binding.owned_outputs.emplace_back(std::move(tensor));
+        }
+
+        const auto& plan = net_.plan_;
+        binding.bottom_mats.resize(plan.size());
+        binding.top_mats.resize(plan.size());
+        for (size_t i = 0; i < plan.size(); ++i) {
+            for (int bottom : plan[i].bottoms) {
+                binding.bottom_mats[i].push_back(binding.blob_mats[bottom]);
+            }
+            for (int top : plan[i].tops) {
+                binding.top_mats[i].push_back(binding.blob_mats[top]);
+            }
+        }
+    }
+
+    // the parked binding gets its own output tensors back so it never refers to caller memory
+    if (layout_) {
+        for (size_t i = 0; i < bound_outputs_.size(); ++i) {
+            if (bound_outputs_[i]) {
+                BindOutput(i, owned_outputs_[i]);
+            }
+        }
+        Binding active;
+        active.layout        = layout_;
+        active.arena         = std::move(arena_);
+        active.blob_mats     = std::move(blob_mats_);
+        active.owned_outputs = std::move(owned_outputs_);
+        active.bottom_mats   = std::move(bottom_mats_);
+        active.top_mats      = std::move(top_mats_);
+        bindings_.emplace_front(std::move(active));
+        const size_t capacity = static_cast<size_t>(std::max(0, net_.option_->shape_cache_size));
+        while (bindings_.size() > capacity) {
+            bindings_.pop_back();
+        }
+    }
+
+    layout_         = binding.layout;
+    arena_          = std::move(binding.arena);
+    blob_mats_      = std::move(binding.blob_mats);
+    owned_outputs_  = std::move(binding.owned_outputs);
+    bottom_mats_    = std::move(binding.bottom_mats);
+    top_mats_       = std::move(binding.top_mats);
+    output_tensors_ = owned_outputs_;
+    segment_owner_.assign(layout_->segment_count, -1);
+    NextGeneration();
+
+    for (size_t i = 0; i < bound_outputs_.size(); ++i) {
+        if (bound_outputs_[i]) {
+            MStatus ret = BindOutput(i, bound_outputs_[i]);
+            if (ret != MStatus::M_OK) {
+                return ret;
+            }
+        }
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Session::Reshape(const std::vector<std::vector<int>>& shapes) {
+    Net::ShapeLayoutPtr layout;
+    MStatus ret = net_.GetLayout(shapes, layout);
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+    ret = Activate(layout);
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+
+    input_shapes_    = shapes;
+    reshape_pending_ = false;
+    for (size_t i = 0; i < input_tensors_.size(); ++i) {
+        if (input_tensors_[i] && TensorCount(input_tensors_[i]) != ShapeCount(shapes[i])) {
+            input_tensors_[i] = nullptr;
+        }
+        if (input_tensors_[i]) {
+            BindInput(i, input_tensors_[i]);
+        }
+    }
+    NextGeneration();
+    return MStatus::M_OK;
+}
+
+MStatus Session::SetInput(size_t idx, const TensorPtr& tensor) {
+    if (idx >= input_tensors_.size() || !tensor || !tensor->GetData<float>()) {
+        SIMPLE_LOG_ERROR("Session::SetInput invalid input %i\n", idx);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // a tensor of the current size keeps the current shape whatever its own dims are
+    const auto& current = GetInputShape(idx);
+    std::vector<int> shape;
+    if (TensorCount(tensor) == ShapeCount(current)) {
+        shape = current;
+    } else if (!TensorShape(tensor, current.size(), shape)) {
+        SIMPLE_LOG_ERROR("Session::SetInput input %i size mismatch, %ivs%i\n",
+                         idx,
+                         TensorCount(tensor),
+                         ShapeCount(current));
+        return MStatus::M_INVALID_ARG;
+    }
+
+    input_tensors_[idx] = tensor;
+    input_shapes_[idx]  = shape;
+    if (shape == current) {
+        BindInput(idx, tensor);
+    } else {
+        reshape_pending_ = true;
+    }
+    NextGeneration();
+    return MStatus::M_OK;
+}
+
+void Session::BindInput(size_t idx, const TensorPtr& tensor) {
+    // graph inputs are read in place from the caller tensors
+    const int index   = net_.input_blob_index_[idx];
+    Mat mat(tensor->GetData<float>(), layout_->shapes[index]);
+    blob_mats_[index] = mat;
+    for (const auto& slot : net_.input_slots_) {
+        if (net_.plan_[slot.first].bottoms[slot.second] == index) {
+            bottom_mats_[slot.first][slot.second] = mat;
+        }
+    }
+}
+
+MStatus Session::SetInput(const std::string& name, const TensorPtr& tensor) {
+    int idx = net_.GetInputIndex(name);
+    if (idx < 0) {
+        SIMPLE_LOG_ERROR("Session::SetInput no input named %s\n", name.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return SetInput(static_cast<size_t>(idx), tensor);
+}
+
+MStatus Session::SetOutput(size_t idx, const TensorPtr& tensor) {
+    if (idx >= output_tensors_.size() || !tensor) {
+        SIMPLE_LOG_ERROR("Session::SetOutput invalid output %i\n", idx);
+        return MStatus::M_INVALID_ARG;
+    }
+    // with new input shapes pending the tensor has to fit them, switch now so it is checked
+    // against the shapes it will be written with
+    if (reshape_pending_) {
+        TensorPtr previous  = bound_outputs_[idx];
+        bound_outputs_[idx] = tensor;
+        MStatus ret         = Reshape(input_shapes_);
+        if (ret != MStatus::M_OK) {
+            bound_outputs_[idx] = previous;
+            return ret;
+        }
+    }
+    MStatus ret = BindOutput(idx, tensor);
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+    bound_outputs_[idx] = tensor;
+    // the new tensor holds nothing computed yet
+    NextGeneration();
+    return MStatus::M_OK;
+}
+
+MStatus Session::BindOutput(size_t idx, const TensorPtr& tensor) {
+    const int index = net_.output_blob_index_[idx];
+    Mat mat(tensor->GetData<float>(), layout_->shapes[index]);
+    if (nullptr == mat.data || TensorCount(tensor) != mat.total()) {
+        SIMPLE_LOG_ERROR("Session::SetOutput output %i size mismatch, %ivs%i\n",
+                         idx,
+                         TensorCount(tensor),
+                         mat.total());
+        return MStatus::M_INVALID_ARG;
+    }
+    output_tensors_[idx] = tensor;
+    blob_mats_[index]    = mat;
+    const int step       = net_.blob_step_[index];
+    if (step >= 0) {
+        for (size_t j = 0; j < net_.plan_[step].tops.size(); ++j) {
+            if (net_.plan_[step].tops[j] == index) {
+                top_mats_[step][j] = mat;
+            }
+        }
+    }
+    for (const auto& slot : net_.output_slots_) {
+        if (net_.plan_[slot.first].bottoms[slot.second] == index) {
+            bottom_mats_[slot.first][slot.second] = mat;
+        }
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Session::SetOutput(const std::string& name, const TensorPtr& tensor) {
+    int idx = net_.GetOutputIndex(name);
+    if (idx < 0) {
+        SIMPLE_LOG_ERROR("Session::SetOutput no output named %s\n", name.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    return SetOutput(static_cast<size_t>(idx), tensor);
+}
+
+MStatus Session::GetOutput(const std::string& name, TensorPtr& tensor) const {
+    int idx = net_.GetOutputIndex(name);
+    if (idx < 0 || static_cast<size_t>(idx) >= output_tensors_.size()) {
+        SIMPLE_LOG_ERROR("Session::GetOutput no output named %s\n", name.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    tensor = output_tensors_[idx];
+    return MStatus::M_OK;
+}
+
+bool Session::IsBoundOutput(const TensorPtr& tensor) const {
+    if (!tensor) {
+        return false;
+    }
+    for (const auto& bound : bound_outputs_) {
+        if (bound == tensor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+MStatus Session::Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output) {
+    if (input.size() != input_tensors_.size()) {
+        SIMPLE_LOG_ERROR("Session::Forward input size mismatch, %ivs%i\n",
+                         input.size(),
+                         input_tensors_.size());
+        return MStatus::M_INVALID_ARG;
+    }
+    for (size_t i = 0; i < input.size(); ++i) {
+        MStatus ret = SetInput(i, input[i]);
+        if (ret != MStatus::M_OK) {
+            return ret;
+        }
+    }
+
+    MStatus ret = Forward();
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+
+    output = output_tensors_;
+    return MStatus::M_OK;
+}
+
+MStatus Session::Forward() {
+    if (reshape_pending_) {
+        MStatus ret = Reshape(input_shapes_);
+        if (ret != MStatus::M_OK) {
+            return ret;
+        }
+    }
+    for (size_t i = 0; i < input_tensors_.size(); ++i) {
+        if (!input_tensors_[i]) {
+            SIMPLE_LOG_ERROR("Session::Forward input %s is not set\n",
+                             net_.input_names_[i].c_str());
+            return MStatus::M_INVALID_ARG;
+        }
+    }
+
+    NextGeneration();
+    const auto& option = net_.option_;
+    Profiler::Clock::time_point begin;
+    if (option->profiler) {
+        begin = Profiler::Clock::now();
+    }
+    MStatus ret = MStatus::M_OK;
+    if (option->executor_mode == ExecutorMode::M_PARALLEL && option->thread_pool) {
+        ret = ForwardParallel();
+    } else {
+        ret = ForwardSequential();
+    }
+    if (option->profiler) {
+        Profiler::Event event;
+        event.name = net_.net_name_;
+        event.type = "net";
+        option->profiler->Record(std::move(event), begin, Profiler::Clock::now());
+    }
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+
+    // steps sharing memory run in plan order in both executors, the last writer holds it
+    for (size_t i = 0; i < net_.plan_.size(); ++i) {
+        MarkComputed(static_cast<int>(i));
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Session::ForwardSequential() {
+    const auto& plan = net_.plan_;
+    for (size_t i = 0; i < plan.size(); ++i) {
+        auto ret = RunLayer(static_cast<int>(i));
+        if (ret != MStatus::M_OK) {
+            SIMPLE_LOG_ERROR("Session::Forward failed, layer_name: %s, layer_index: %i\n",
+                             plan[i].layer->GetName().c_str(),
+                             plan[i].layer_index);
+            return ret;
+        }
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Session::ForwardParallel() {
+    const auto& plan = net_.plan_;
+    if (plan.empty()) {
+        return MStatus::M_OK;
+    }
+
+    for (size_t i = 0; i < plan.size(); ++i) {
+        pending_[i].store(plan[i].dependency, std::memory_order_relaxed);
+    }
+    failed_.store(false);
+    finished_.store(0);
+    status_ = MStatus::M_OK;
+
+    auto& pool = net_.option_->thread_pool;
+    for (size_t i = 0; i < plan.size(); ++i) {
+        if (!plan[i].dependency) {
+            int step_index = static_cast<int>(i);
+            pool->Submit([this, step_index] { RunStep(step_index); });
+        }
+    }
+
+    // the calling thread executes ready steps too while waiting
+    pool->Wait([this] { return finished_.load(std::memory_order_acquire) == net_.plan_.size(); });
+    return status_;
+}
+
+void Session::RunStep(int step_index) {
+    const auto& step = net_.plan_[step_index];
+
+    // after a failure the remaining steps only drain their dependency counters
+    if (!failed_.load(std::memory_order_relaxed)) {
+        auto ret = RunLayer(step_index);
+        if (ret != MStatus::M_OK) {
+            SIMPLE_LOG_ERROR("Session::Forward failed, layer_name: %s, layer_index: %i\n",
+                             step.layer->GetName().c_str(),
+                             step.layer_index);
+            if (!failed_.exchange(true)) {
+                status_ = ret;
+            }
+        }
+    }
+
+    for (int next : step.successors) {
+        if (pending_[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            net_.option_->thread_pool->Submit([this, next] { RunStep(next); });
+        }
+    }
+
+    // the session may be gone as soon as the last step is counted, keep only the pool
+    const size_t step_count = net_.plan_.size();
+    ThreadPool* pool        = net_.option_->thread_pool.get();
+    if (finished_.fetch_add(1, std::memory_order_acq_rel) + 1 == step_count) {
+        pool->Notify();
+    }
+}
+MStatus Session::Extract(const std::string& name, TensorPtr& tensor) {
+    int output = net_.GetOutputIndex(name);
+    int input  = net_.GetInputIndex(name);
+    int index  = output >= 0  ? net_.output_blob_index_[output]
+                 : input >= 0 ? net_.input_blob_index_[input]
+                              : net_.find_blob_index_by_name(name);
+    if (index < 0) {
+        SIMPLE_LOG_ERROR("Session::Extract no blob named %s\n", name.c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+
+    MStatus ret = MStatus::M_OK;
+    if (reshape_pending_) {
+        ret = Reshape(input_shapes_);
+        if (ret != MStatus::M_OK) {
+            return ret;
+        }
+    }
+    ret = Evaluate(index);
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+
+    if (output >= 0) {
+        tensor = output_tensors_[output];
+        return MStatus::M_OK;
+    }
+    if (input >= 0) {
+        tensor = input_tensors_[input];
+        return MStatus::M_OK;
+    }
+    const auto& blob_shape = layout_->shapes[index];
+    const Mat& mat         = blob_mats_[index];
+    std::vector<uint32_t> shape(blob_shape.begin(), blob_shape.end());
+    tensor = std::make_shared<base::Tensor>(
+        shape, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    tensor->SetName(net_.blobs_[index].name);
+    memcpy(tensor->GetData<float>(), mat.data, mat.total() * sizeof(float));
+    return MStatus::M_OK;
+}
+
+MStatus Session::Evaluate(int blob) {
+    const auto& plan = net_.plan_;
+    const int root   = net_.blob_step_[blob];
+    if (root < 0) {
+        int input = net_.GetInputIndex(net_.blobs_[blob].name);
+        if (input < 0 || !input_tensors_[input]) {
+            SIMPLE_LOG_ERROR("Session::Extract blob %s is not computed by any layer or bound\n",
+                             net_.blobs_[blob].name.c_str());
+            return MStatus::M_INVALID_ARG;
+        }
+        return MStatus::M_OK;
+    }
+    if (IsComputed(root)) {
+        return MStatus::M_OK;
+    }
+
+    // producers that are not computed yet, walked back from the root
+    std::vector<bool> needed(plan.size(), false);
+    std::vector<int> steps;
+    std::vector<int> stack(1, root);
+    auto collect = [&]() -> MStatus {
+        while (!stack.empty()) {
+            int index = stack.back();
+            stack.pop_back();
+            if (needed[index] || IsComputed(index)) {
+                continue;
+            }
+            needed[index] = true;
+            steps.push_back(index);
+            for (int bottom : plan[index].bottoms) {
+                int producer = net_.blob_step_[bottom];
+                if (producer >= 0) {
+                    stack.push_back(producer);
+                    continue;
+                }
+                int input = net_.GetInputIndex(net_.blobs_[bottom].name);
+                if (input < 0 || !input_tensors_[input]) {
+                    SIMPLE_LOG_ERROR("Session::Extract input %s is not set\n",
+                                     net_.blobs_[bottom].name.c_str());
+                    return MStatus::M_INVALID_ARG;
+                }
+            }
+        }
+        return MStatus::M_OK;
+    };
+    MStatus ret = collect();
+
+    // a computed step read by the steps to run is overwritten when one of them shares its
+    // memory and comes first in plan order, such a step is recomputed too until none is left
+    for (bool grown = true; grown && ret == MStatus::M_OK;) {
+        grown = false;
+        std::vector<int> order(steps);
+        for (int index : steps) {
+            for (int bottom : plan[index].bottoms) {
+                int producer = net_.blob_step_[bottom];
+                if (producer >= 0 && !needed[producer]) {
+                    order.push_back(producer);
+                }
+            }
+        }
+        std::sort(order.begin(), order.end());
+        order.erase(std::unique(order.begin(), order.end()), order.end());
+
+        std::vector<bool> written(layout_->segment_count, false);
+        for (int index : order) {
+            bool overwritten = false;
+            for (int top : plan[index].tops) {
+                const auto& segments = layout_->blob_segments[top];
+                for (int seg = segments.first; seg < segments.second; ++seg) {
+                    overwritten = overwritten || written[seg];
+                    written[seg] = written[seg] || needed[index];
+                }
+            }
+            if (!needed[index] && overwritten) {
+                computed_[index] = 0;
+                stack.push_back(index);
+                ret   = collect();
+                grown = true;
+                break;
+            }
+        }
+    }
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+
+    // plan order keeps every needed blob alive from its producer to its last needed consumer
+    std::sort(steps.begin(), steps.end());
+    for (int index : steps) {
+        ret = RunLayer(index);
+        if (ret != MStatus::M_OK) {
+            SIMPLE_LOG_ERROR("Session::Extract failed, layer_name: %s, layer_index: %i\n",
+                             plan[index].layer->GetName().c_str(),
+                             plan[index].layer_index);
+            return ret;
+        }
+        MarkComputed(index);
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Session::RunLayer(int step_index) {
+    const Layer* layer  = net_.plan_[step_index].layer;
+    const auto& bottoms = bottom_mats_[step_index];
+    auto& tops          = top_mats_[step_index];
+    Profiler* profiler  = net_.option_->profiler.get();
+    if (nullptr == profiler) {
+        return layer->Forward(bottoms, tops);
+    }
+
+    const auto begin = Profiler::Clock::now();
+    MStatus ret      = layer->Forward(bottoms, tops);
+    const auto end   = Profiler::Clock::now();
+    Profiler::Event event;
+    event.name = layer->GetName();
+    event.type = layer->GetTypeName();
+    for (const auto& mat : bottoms) {
+        event.bytes_read += mat.total() * sizeof(float);
+    }
+    for (const auto& mat : tops) {
+        event.bytes_written += mat.total() * sizeof(float);
+    }
+    event.flops = layer->GetFlops(bottoms, tops);
+    profiler->Record(std::move(event), begin, end);
+    return ret;
+}
+
+void Session::NextGeneration() {
+    // 0 marks a step never computed, the counters are only cleared when the generation wraps
+    if (++generation_ == 0) {
+        std::fill(computed_.begin(), computed_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+bool Session::IsComputed(int step_index) const {
+    if (computed_[step_index] != generation_) {
+        return false;
+    }
+    for (int top : net_.plan_[step_index].tops) {
+        const auto& segments = layout_->blob_segments[top];
+        for (int seg = segments.first; seg < segments.second; ++seg) {
+            if (segment_owner_[seg] != step_index) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Session::MarkComputed(int step_index) {
+    computed_[step_index] = generation_;
+    for (int top : net_.plan_[step_index].tops) {
+        const auto& segments = layout_->blob_segments[top];
+        for (int seg = segments.first; seg < segments.second; ++seg) {
+            segment_owner_[seg] = step_index;
+        }
+    }
+}
+} // namespace nn
@@ -0,0 +1,159 @@
+#ifndef SIMPLE_NN_SESSION_H_
+#define SIMPLE_NN_SESSION_H_
+
+#include "runtime/mat.h"
+#include "runtime/net.h"
+#include "utils/aligned_buffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nn {
+/// @brief per request state of a Net, the blob memory, the bound inputs and outputs and the
+/// executor counters of one inference. the net is only read, so any number of sessions run
+/// one initialized net concurrently and share its layers and weights without locking. a
+/// session is used by one thread at a time and must not outlive its net.
+/// inputs may take other shapes than the static ones of the model, the shapes are propagated
+/// through the layers and the memory planned for them is kept per input shape signature, so
+/// returning to a recent signature only rebinds the tensors
+class Session {
+public:
+    using TensorPtr = Net::TensorPtr;
+
+public:
+    explicit Session(const Net& net);
+    ~Session() = default;
+
+    /// @brief allocate the arena of the net memory plan and bind every blob to it
+    MStatus Init();
+
+    /// @brief bind a caller tensor to a graph input, it is read in place by Forward and kept
+    /// until it is bound again. a tensor holding as many floats as the current input shape
+    /// takes that shape, any other tensor of the same rank (trailing 1 ignored) switches the
+    /// net to its shape on the next Forward or Extract
+    /// @param name name of the pnnx.Input op or of its blob
+    MStatus SetInput(const std::string& name, const TensorPtr& tensor);
+    MStatus SetInput(size_t idx, const TensorPtr& tensor);
+
+    /// @brief bind a caller tensor to a graph output, the layer producing it writes straight
+    /// into it from then on, it must hold the output shape of the current input shapes, those
+    /// set by SetInput included. a run at input shapes it does not fit fails and keeps it bound
+    /// @param name name of the pnnx.Output op or of its blob
+    MStatus SetOutput(const std::string& name, const TensorPtr& tensor);
+    MStatus SetOutput(size_t idx, const TensorPtr& tensor);
+
+    /// @brief switch to new input shapes ahead of binding inputs, the memory for them is
+    /// planned on first use and reused afterwards. inputs bound with another size are unbound
+    /// @param shapes one shape per graph input in input order
+    MStatus Reshape(const std::vector<std::vector<int>>& shapes);
+
+    /// @brief shape the idx-th graph input/output has with the current input shapes
+    const std::vector<int>& GetInputShape(size_t idx) const {
+        return layout_->shapes[net_.input_blob_index_[idx]];
+    }
+    const std::vector<int>& GetOutputShape(size_t idx) const {
+        return layout_->shapes[net_.output_blob_index_[idx]];
+    }
+
+    /// @brief run the net on the inputs bound by SetInput
+    MStatus Forward();
+
+    /// @brief bind input by position, run and return every output
+    MStatus Forward(const std::vector<TensorPtr>& input, std::vector<TensorPtr>& output);
+
+    /// @brief output tensor of the last Forward, overwritten by the next one, a tensor bound by
+    /// SetOutput is returned as is
+    /// @param name name of the pnnx.Output op or of its blob
+    MStatus GetOutput(const std::string& name, TensorPtr& tensor) const;
+
+    /// @brief whether tensor is one the caller bound to an output by SetOutput
+    bool IsBoundOutput(const TensorPtr& tensor) const;
+
+    /// @brief run only the layers the named blob depends on and return it. layers computed
+    /// since the inputs were bound are not run again, inputs the blob does not depend on need
+    /// not be bound. a graph output is returned as its output tensor, an intermediate blob as
+    /// a copy since its arena memory is reused by later layers
+    /// @param name name of a pnnx.Output op or of any blob
+    MStatus Extract(const std::string& name, TensorPtr& tensor);
+
+    const Net& GetNet() const { return net_; }
+
+private:
+    Session(const Session&);
+    Session& operator=(const Session&);
+
+    // memory bound for one layout, the active one lives in the members below and the others
+    // wait in bindings_ until their input shapes come back
+    struct Binding {
+        Net::ShapeLayoutPtr layout;
+        AlignedBuffer arena;
+        std::vector<Mat> blob_mats;
+        std::vector<TensorPtr> owned_outputs;
+        std::vector<std::vector<Mat>> bottom_mats;
+        std::vector<std::vector<Mat>> top_mats;
+    };
+
+    // make layout the active one, reusing its parked binding when there is one
+    MStatus Activate(const Net::ShapeLayoutPtr& layout);
+    // point the blob of a graph input/output and the plan steps using it at tensor
+    void BindInput(size_t idx, const TensorPtr& tensor);
+    MStatus BindOutput(size_t idx, const TensorPtr& tensor);
+
+    MStatus ForwardSequential();
+    MStatus ForwardParallel();
+    void RunStep(int step_index);
+    // forward of one plan step, timed when the net option has a profiler
+    MStatus RunLayer(int step_index);
+
+    // compute the producer of blob and whatever it needs that is not computed yet
+    MStatus Evaluate(int blob);
+    // binding inputs or a full Forward starts a generation, results of the previous one are
+    // stale without touching them
+    void NextGeneration();
+    // a step result is valid until a step sharing its arena memory runs
+    bool IsComputed(int step_index) const;
+    void MarkComputed(int step_index);
+
+private:
+    const Net& net_;
+
+    // shapes and memory plan of the active binding
+    Net::ShapeLayoutPtr layout_{nullptr};
+    // intermediate blobs live in the arena, graph outputs in persistent tensors
+    AlignedBuffer arena_;
+    std::vector<Mat> blob_mats_;
+    std::vector<TensorPtr> input_tensors_;
+    std::vector<TensorPtr> output_tensors_;
+    // output tensors of the active binding, and the caller tensors bound by SetOutput
+    std::vector<TensorPtr> owned_outputs_;
+    std::vector<TensorPtr> bound_outputs_;
+
+    // views of every plan step bound to the memory of this session
+    std::vector<std::vector<Mat>> bottom_mats_;
+    std::vector<std::vector<Mat>> top_mats_;
+
+    // shape of every bound input, Forward and Extract reshape first when they differ from
+    // the active layout
+    std::vector<std::vector<int>> input_shapes_;
+    bool reshape_pending_{false};
+    // parked bindings of other layouts, most recently used first
+    std::list<Binding> bindings_;
+
+    // generation every plan step last ran in, and the step that last wrote every arena segment
+    uint32_t generation_{0};
+    std::vector<uint32_t> computed_;
+    std::vector<int> segment_owner_;
+
+    // parallel executor state
+    std::unique_ptr<std::atomic<int>[]> pending_{nullptr};
+    std::atomic<bool> failed_{false};
+    std::atomic<size_t> finished_{0};
+    MStatus status_{MStatus::M_OK};
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_SESSION_H_
@@ -0,0 +1,58 @@
+#include "runtime/stream.h"
+
+namespace nn {
+Stream::Stream() {
+    thread_ = std::thread(&Stream::WorkerLoop, this);
+}
+
+Stream::~Stream() {
+    {
+        std::lock_guard<std::mutex> lck(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Stream::Enqueue(Task task) {
+    {
+        std::lock_guard<std::mutex> lck(mutex_);
+        tasks_.emplace_back(std::move(task));
+    }
+    cond_.notify_one();
+}
+
+void Stream::Synchronize() {
+    std::unique_lock<std::mutex> lck(mutex_);
+    idle_cond_.wait(lck, [this] { return tasks_.empty() && !busy_; });
+}
+
+Stream* Stream::GetDefault() {
+    static Stream stream;
+    return &stream;
+}
+
+void Stream::WorkerLoop() {
+    std::unique_lock<std::mutex> lck(mutex_);
+    for (;;) {
+        cond_.wait(lck, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+            return;
+        }
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+        busy_ = true;
+        lck.unlock();
+        task();
+        // release what the task captured before taking the lock again
+        task = nullptr;
+        lck.lock();
+        busy_ = false;
+        if (tasks_.empty()) {
+            idle_cond_.notify_all();
+        }
+    }
+}
+} // namespace nn
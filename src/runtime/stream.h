@@ -0,0 +1,50 @@
+#ifndef SIMPLE_NN_STREAM_H_
+#define SIMPLE_NN_STREAM_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace nn {
+/// @brief in order executor behind the void* stream handle of the asynchronous
+/// InferBase::Run. tasks run one at a time on a dedicated thread in the order they were
+/// enqueued, so work queued on one stream never overlaps while separate streams run
+/// concurrently
+class Stream {
+public:
+    using Task = std::function<void()>;
+
+public:
+    Stream();
+    /// @brief runs what is still queued, then joins the thread
+    ~Stream();
+
+    /// @brief queue a task and return right away
+    void Enqueue(Task task);
+
+    /// @brief block until every task queued so far finished, must not be called from a task
+    void Synchronize();
+
+    /// @brief stream used when no handle is given, shared by the whole process
+    static Stream* GetDefault();
+
+private:
+    Stream(const Stream&);
+    Stream& operator=(const Stream&);
+
+    void WorkerLoop();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::condition_variable idle_cond_;
+    std::deque<Task> tasks_;
+    bool busy_{false};
+    bool stop_{false};
+    std::thread thread_;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_STREAM_H_
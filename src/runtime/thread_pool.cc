@@ -0,0 +1,216 @@
+#include "runtime/thread_pool.h"
+
+#include <algorithm>
+#include <log.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define NN_CPU_RELAX() _mm_pause()
+#else
+#define NN_CPU_RELAX() std::this_thread::yield()
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace nn {
+namespace {
+// pool and queue index of the current thread when it is a worker
+thread_local ThreadPool* tls_pool = nullptr;
+thread_local int tls_index        = -1;
+
+void SetAffinity(std::thread& thread, int cpu) {
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    int ret = pthread_setaffinity_np(thread.native_handle(), sizeof(mask), &mask);
+    if (ret != 0) {
+        SIMPLE_LOG_WARN("ThreadPool set affinity to cpu %i failed, %i\n", cpu, ret);
+    }
+#endif
+}
+
+struct ParallelJob {
+    std::atomic<int64_t> next{0};
+    std::atomic<int64_t> done{0};
+    int64_t chunks;
+    int64_t begin;
+    int64_t size;
+    const ThreadPool::RangeTask* fn;
+
+    // claim and run chunks until none are left, true when this call finished the last one
+    bool Run() {
+        bool last = false;
+        for (;;) {
+            int64_t chunk = next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= chunks) {
+                return last;
+            }
+            (*fn)(begin + size * chunk / chunks, begin + size * (chunk + 1) / chunks);
+            last = done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks;
+        }
+    }
+};
+} // namespace
+
+ThreadPool::ThreadPool(int num_threads, int spin_count, const std::vector<int>& cpu_affinity)
+    : spin_count_(spin_count < 0 ? 0 : spin_count) {
+    const int num_workers = num_threads > 1 ? num_threads - 1 : 0;
+
+    // one extra queue receives tasks submitted from threads outside the pool
+    for (int i = 0; i < num_workers + 1; ++i) {
+        queues_.emplace_back(new WorkQueue());
+    }
+
+    workers_.reserve(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+        if (!cpu_affinity.empty()) {
+            SetAffinity(workers_.back(), cpu_affinity[i % cpu_affinity.size()]);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    stop_.store(true);
+    Notify();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(Task task) {
+    int index = tls_pool == this ? tls_index
+                                 : static_cast<int>(next_queue_.fetch_add(1) % queues_.size());
+    {
+        std::lock_guard<std::mutex> lck(queues_[index]->mutex);
+        queues_[index]->tasks.emplace_back(std::move(task));
+    }
+    queued_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lck(sleep_mutex_);
+        sleep_cond_.notify_one();
+    }
+}
+
+void ThreadPool::ParallelFor(int64_t begin, int64_t end, const RangeTask& fn, int64_t grain) {
+    const int64_t size = end - begin;
+    if (size <= 0) {
+        return;
+    }
+    grain = grain < 1 ? 1 : grain;
+
+    // a few chunks per thread so uneven chunks still balance
+    int64_t chunks = (size + grain - 1) / grain;
+    chunks         = std::min<int64_t>(chunks, static_cast<int64_t>(GetThreadNum()) * 4);
+    if (chunks <= 1 || workers_.empty()) {
+        fn(begin, end);
+        return;
+    }
+
+    // helpers may be dequeued after the job is done, they then find no chunk left and never
+    // touch fn again, so only the job itself must outlive this call
+    auto job    = std::make_shared<ParallelJob>();
+    job->chunks = chunks;
+    job->begin  = begin;
+    job->size   = size;
+    job->fn     = &fn;
+
+    const int64_t helpers = std::min<int64_t>(static_cast<int64_t>(workers_.size()), chunks - 1);
+    for (int64_t i = 0; i < helpers; ++i) {
+        Submit([this, job] {
+            if (job->Run()) {
+                Notify();
+            }
+        });
+    }
+
+    job->Run();
+    Wait([&job] { return job->done.load(std::memory_order_acquire) == job->chunks; });
+}
+
+void ThreadPool::Wait(const std::function<bool()>& done) {
+    const int self = tls_pool == this ? tls_index : -1;
+    int spins      = 0;
+    while (!done()) {
+        if (RunOneTask(self)) {
+            spins = 0;
+            continue;
+        }
+        if (spins++ < spin_count_) {
+            NN_CPU_RELAX();
+            continue;
+        }
+        Sleep(done);
+        spins = 0;
+    }
+}
+
+void ThreadPool::Notify() {
+    std::lock_guard<std::mutex> lck(sleep_mutex_);
+    sleep_cond_.notify_all();
+}
+
+void ThreadPool::WorkerLoop(int index) {
+    tls_pool  = this;
+    tls_index = index;
+
+    auto stopped = [this] { return stop_.load(); };
+    int spins    = 0;
+    while (!stop_.load(std::memory_order_relaxed)) {
+        if (RunOneTask(index)) {
+            spins = 0;
+            continue;
+        }
+        if (spins++ < spin_count_) {
+            NN_CPU_RELAX();
+            continue;
+        }
+        Sleep(stopped);
+        spins = 0;
+    }
+}
+
+bool ThreadPool::RunOneTask(int self) {
+    if (queued_.load(std::memory_order_relaxed) <= 0) {
+        return false;
+    }
+
+    Task task;
+    const int count = static_cast<int>(queues_.size());
+    // own queue newest first, then steal the oldest task of the others
+    if (self >= 0) {
+        std::lock_guard<std::mutex> lck(queues_[self]->mutex);
+        if (!queues_[self]->tasks.empty()) {
+            task = std::move(queues_[self]->tasks.back());
+            queues_[self]->tasks.pop_back();
+        }
+    }
+    const int start = self >= 0 ? self + 1 : 0;
+    for (int i = 0; i < count && !task; ++i) {
+        WorkQueue& queue = *queues_[(start + i) % count];
+        std::lock_guard<std::mutex> lck(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) {
+        return false;
+    }
+
+    queued_.fetch_sub(1);
+    task();
+    return true;
+}
+
+void ThreadPool::Sleep(const std::function<bool()>& wake) {
+    std::unique_lock<std::mutex> lck(sleep_mutex_);
+    sleepers_.fetch_add(1);
+    sleep_cond_.wait(lck, [&] { return queued_.load() > 0 || stop_.load() || wake(); });
+    sleepers_.fetch_sub(1);
+}
+} // namespace nn
@@ -0,0 +1,78 @@
+#ifndef SIMPLE_NN_THREAD_POOL_H_
+#define SIMPLE_NN_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nn {
+/// @brief work stealing thread pool, every worker owns a deque and pops its own tasks LIFO
+/// while idle workers steal FIFO from the others. num_threads counts the calling thread as
+/// well, so a pool of N spawns N-1 workers and the caller of ParallelFor/Wait runs tasks too.
+/// sharing one pool bounds the spawned workers only, every external thread blocked in
+/// ParallelFor/Wait (scheduler workers, streams, concurrent sessions) runs tasks alongside
+/// them, so K such callers bring the running threads to num_threads - 1 + K
+class ThreadPool {
+public:
+    using Task      = std::function<void()>;
+    using RangeTask = std::function<void(int64_t begin, int64_t end)>;
+
+public:
+    /// @param[in] num_threads total concurrency, including the calling thread
+    /// @param[in] spin_count busy wait iterations before an idle thread goes to sleep
+    /// @param[in] cpu_affinity cpu ids the workers are pinned to round robin, empty for none
+    explicit ThreadPool(int num_threads,
+                        int spin_count                       = 20000,
+                        const std::vector<int>& cpu_affinity = {});
+    ~ThreadPool();
+
+    /// @brief queue a task, tasks may submit further tasks
+    void Submit(Task task);
+
+    /// @brief split [begin, end) into chunks of at least grain items and run fn over them on
+    /// the workers and the calling thread, returns once every chunk is done. nested calls
+    /// from inside a task are safe, the waiting thread keeps executing queued tasks
+    void ParallelFor(int64_t begin, int64_t end, const RangeTask& fn, int64_t grain = 1);
+
+    /// @brief run queued tasks on the calling thread until done() holds
+    void Wait(const std::function<bool()>& done);
+
+    /// @brief wake threads blocked in Wait to re-check their condition
+    void Notify();
+
+    int GetThreadNum() const { return static_cast<int>(workers_.size()) + 1; }
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(int index);
+    bool RunOneTask(int self);
+    void Sleep(const std::function<bool()>& wake);
+
+private:
+    int spin_count_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<int64_t> queued_{0};
+    std::atomic<int> sleepers_{0};
+    std::atomic<uint32_t> next_queue_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cond_;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_THREAD_POOL_H_
@@ -0,0 +1,65 @@
+#include "utils/aligned_buffer.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace nn {
+AlignedBuffer::AlignedBuffer(size_t size) {
+    Resize(size);
+}
+
+AlignedBuffer::~AlignedBuffer() {
+    Release();
+}
+
+AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) : data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+AlignedBuffer& AlignedBuffer::operator=(AlignedBuffer&& other) {
+    if (this != &other) {
+        Release();
+        data_       = other.data_;
+        size_       = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+bool AlignedBuffer::Resize(size_t size) {
+    Release();
+    if (!size) {
+        return true;
+    }
+
+    void* ptr = nullptr;
+#ifdef _WIN32
+    ptr = _aligned_malloc(AlignSize(size), MEMORY_ALIGNMENT);
+#else
+    if (posix_memalign(&ptr, MEMORY_ALIGNMENT, AlignSize(size)) != 0) {
+        ptr = nullptr;
+    }
+#endif
+    if (!ptr) {
+        return false;
+    }
+    memset(ptr, 0, AlignSize(size));
+    data_ = static_cast<uint8_t*>(ptr);
+    size_ = size;
+    return true;
+}
+
+void AlignedBuffer::Release() {
+    if (data_) {
+#ifdef _WIN32
+        _aligned_free(data_);
+#else
+        free(data_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+} // namespace nn
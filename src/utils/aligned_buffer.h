@@ -0,0 +1,46 @@
+#ifndef SIMPLE_NN_ALIGNED_BUFFER_H_
+#define SIMPLE_NN_ALIGNED_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nn {
+constexpr size_t MEMORY_ALIGNMENT = 64;
+
+inline size_t AlignSize(size_t size, size_t align = MEMORY_ALIGNMENT) {
+    return (size + align - 1) / align * align;
+}
+
+/// @brief owned, cache line aligned and zero initialized byte buffer
+class AlignedBuffer {
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t size);
+    ~AlignedBuffer();
+
+    AlignedBuffer(AlignedBuffer&& other);
+    AlignedBuffer& operator=(AlignedBuffer&& other);
+
+    /// @brief reallocate to size bytes, previous content is dropped
+    bool Resize(size_t size);
+    void Release();
+
+    uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+    template <typename T>
+    T* As() const {
+        return reinterpret_cast<T*>(data_);
+    }
+
+private:
+    AlignedBuffer(const AlignedBuffer&);
+    AlignedBuffer& operator=(const AlignedBuffer&);
+
+private:
+    uint8_t* data_{nullptr};
+    size_t size_{0};
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_ALIGNED_BUFFER_H_
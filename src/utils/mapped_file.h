@@ -0,0 +1,33 @@
+#ifndef SIMPLE_NN_MAPPED_FILE_H_
+#define SIMPLE_NN_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nn {
+/// @brief whole file mapped read only, pages are shared with every process mapping the same
+/// file and only faulted in when touched
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    /// @brief map path, a previous mapping is released first
+    bool Open(const std::string& path);
+    void Close();
+
+    const uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+private:
+    uint8_t* data_{nullptr};
+    size_t size_{0};
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_MAPPED_FILE_H_
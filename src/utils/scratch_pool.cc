@@ -0,0 +1,52 @@
+#include "utils/scratch_pool.h"
+
+namespace nn {
+bool ScratchPool::Resize(int slots, size_t slot_size) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    slots_.clear();
+    free_.clear();
+    slot_size_ = slot_size;
+    if (!slot_size) {
+        return true;
+    }
+    for (int i = 0; i < slots; ++i) {
+        std::unique_ptr<AlignedBuffer> slot(new AlignedBuffer());
+        if (!slot->Resize(slot_size)) {
+            return false;
+        }
+        free_.push_back(slot->Data());
+        slots_.emplace_back(std::move(slot));
+    }
+    return true;
+}
+
+uint8_t* ScratchPool::Acquire() {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (!free_.empty()) {
+        uint8_t* slot = free_.back();
+        free_.pop_back();
+        return slot;
+    }
+    // more threads than ever before run the kernel at once, callers outside the thread pool
+    // such as scheduler workers get here the first time
+    if (!slot_size_) {
+        return nullptr;
+    }
+    std::unique_ptr<AlignedBuffer> slot(new AlignedBuffer());
+    if (!slot->Resize(slot_size_)) {
+        return nullptr;
+    }
+    slots_.emplace_back(std::move(slot));
+    // Release then never grows free_
+    free_.reserve(slots_.size());
+    return slots_.back()->Data();
+}
+
+void ScratchPool::Release(uint8_t* slot) {
+    if (!slot) {
+        return;
+    }
+    std::lock_guard<std::mutex> lck(mutex_);
+    free_.push_back(slot);
+}
+} // namespace nn
@@ -0,0 +1,45 @@
+#ifndef SIMPLE_NN_SCRATCH_POOL_H_
+#define SIMPLE_NN_SCRATCH_POOL_H_
+
+#include "utils/aligned_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nn {
+/// @brief equally sized cache line aligned buffers handed to the threads running a kernel at
+/// the same time, so kernels needing scratch memory do not allocate on every call. the slots
+/// are allocated up front, a thread finding every slot taken adds one that is kept from then on
+class ScratchPool {
+public:
+    ScratchPool()  = default;
+    ~ScratchPool() = default;
+
+    /// @brief drop every slot and allocate slots buffers of slot_size bytes, none may be
+    /// acquired
+    bool Resize(int slots, size_t slot_size);
+
+    /// @brief take a free slot of GetSlotSize bytes, nullptr when a new one can not be allocated
+    uint8_t* Acquire();
+
+    /// @brief give back a slot returned by Acquire
+    void Release(uint8_t* slot);
+
+    size_t GetSlotSize() const { return slot_size_; }
+
+private:
+    ScratchPool(const ScratchPool&);
+    ScratchPool& operator=(const ScratchPool&);
+
+private:
+    size_t slot_size_{0};
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<AlignedBuffer>> slots_;
+    std::vector<uint8_t*> free_;
+};
+} // namespace nn
+
+#endif // SIMPLE_NN_SCRATCH_POOL_H_
@@ -0,0 +1,77 @@
+#include "conv_util.h"
+#include "runtime/cpu.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+// nn.Conv2d through the im2col gemm, its direct 1x1 path and the depthwise kernels against a
+// direct convolution, with the kernel level forced through NetOption::cpu_isa. levels the
+// host can not run fall back to the best one it can
+namespace {
+using conv_test::ConvCase;
+using nn::CpuIsa;
+
+// in_channels, out_channels, groups, in_h, in_w, kernel, stride, pad and dilation per axis
+const ConvCase CASES[] = {
+    // im2col with pads larger than 1 and a stride, output rows no panel width divides
+    {3, 16, 1, 17, 19, 3, 3, 2, 2, 2, 2, 1, 1},
+    {4, 7, 1, 30, 30, 6, 6, 2, 2, 2, 2, 1, 1},
+    // more than one K block, 300 * 3 * 3 rows
+    {300, 20, 1, 7, 7, 3, 3, 1, 1, 1, 1, 1, 1},
+    // uneven kernel, stride and pad per axis
+    {5, 9, 1, 8, 9, 3, 1, 1, 2, 1, 0, 1, 1},
+    // 1x1 read in place and 1x1 with a stride
+    {16, 33, 1, 13, 13, 1, 1, 1, 1, 0, 0, 1, 1},
+    {16, 24, 1, 13, 13, 1, 1, 2, 2, 0, 0, 1, 1},
+    // grouped
+    {12, 18, 3, 15, 15, 3, 3, 1, 1, 1, 1, 1, 1},
+    // depthwise, dilated with pad 2, 5x5 with pad 2, stride 2 and a row shorter than the filter
+    {6, 6, 6, 11, 33, 3, 3, 1, 1, 2, 2, 2, 2},
+    {12, 12, 12, 9, 40, 5, 5, 1, 1, 2, 2, 1, 1},
+    {8, 8, 8, 20, 37, 3, 3, 2, 2, 1, 1, 1, 1},
+    {4, 4, 4, 5, 50, 1, 7, 1, 1, 0, 3, 1, 1},
+};
+
+class ConvTest : public ::testing::TestWithParam<CpuIsa> {};
+
+TEST_P(ConvTest, MatchesDirectConvolution) {
+    const std::string path = ::testing::TempDir() + "conv_test";
+    std::mt19937 rng(1);
+    for (const auto& c : CASES) {
+        const size_t weight_size = static_cast<size_t>(c.out_channels) * c.FilterSize();
+        const size_t input_size  = static_cast<size_t>(c.in_channels) * c.in_h * c.in_w;
+        const auto weight        = conv_test::Random(weight_size, rng);
+        const auto bias          = conv_test::Random(c.out_channels, rng);
+        const auto x             = conv_test::Random(input_size, rng);
+        ASSERT_TRUE(conv_test::WriteConvModel(path, c, weight, bias));
+        const auto ref = conv_test::NaiveConv(c, x, weight, bias);
+
+        for (int threads : {1, 3}) {
+            auto option            = std::make_shared<nn::NetOption>();
+            option->cpu_isa        = GetParam();
+            option->conv_algorithm = nn::ConvAlgorithm::M_IM2COL_GEMM;
+            option->num_threads    = threads;
+            std::vector<float> y;
+            ASSERT_EQ(conv_test::RunConvNet(path, c, option, x, y), MStatus::M_OK);
+            ASSERT_EQ(y.size(), ref.size());
+            for (size_t i = 0; i < y.size(); ++i) {
+                ASSERT_NEAR(y[i], ref[i], 1e-3f)
+                    << "channels " << c.in_channels << " -> " << c.out_channels << " groups "
+                    << c.groups << " kernel " << c.kernel_h << "x" << c.kernel_w << " threads "
+                    << threads << " at " << i;
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(CpuIsa,
+                         ConvTest,
+                         ::testing::Values(CpuIsa::M_GENERIC,
+                                           CpuIsa::M_SSE42,
+                                           CpuIsa::M_AVX2,
+                                           CpuIsa::M_AVX512,
+                                           CpuIsa::M_AVX512_VNNI));
+} // namespace
@@ -0,0 +1,163 @@
+#ifndef SIMPLE_NN_TESTS_CONV_UTIL_H_
+#define SIMPLE_NN_TESTS_CONV_UTIL_H_
+
+#include "runtime/net.h"
+#include "runtime/pnnx/store_zip.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// a single nn.Conv2d model and the direct convolution it is checked against, shared by the
+// convolution tests
+namespace conv_test {
+struct ConvCase {
+    int in_channels;
+    int out_channels;
+    int groups;
+    int in_h;
+    int in_w;
+    int kernel_h;
+    int kernel_w;
+    int stride_h;
+    int stride_w;
+    int pad_h;
+    int pad_w;
+    int dilation_h;
+    int dilation_w;
+
+    int OutH() const { return (in_h + 2 * pad_h - dilation_h * (kernel_h - 1) - 1) / stride_h + 1; }
+    int OutW() const { return (in_w + 2 * pad_w - dilation_w * (kernel_w - 1) - 1) / stride_w + 1; }
+    // floats of one filter, the weight holds out_channels of them
+    int FilterSize() const { return in_channels / groups * kernel_h * kernel_w; }
+};
+
+inline std::vector<float> Random(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> value(-0.5f, 0.5f);
+    std::vector<float> data(count);
+    for (auto& v : data) {
+        v = value(rng);
+    }
+    return data;
+}
+
+/// @brief write path.param and path.bin of pnnx.Input -> nn.Conv2d with bias -> pnnx.Output
+/// for one image of the case
+inline bool WriteConvModel(const std::string& path,
+                           const ConvCase& c,
+                           const std::vector<float>& weight,
+                           const std::vector<float>& bias) {
+    pnnx::StoreZipWriter writer;
+    if (writer.open(path + ".bin") != 0) {
+        return false;
+    }
+    writer.write_file("conv.weight", (const char*)weight.data(), weight.size() * sizeof(float));
+    writer.write_file("conv.bias", (const char*)bias.data(), bias.size() * sizeof(float));
+    writer.close();
+
+    FILE* fp = fopen((path + ".param").c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "7767517\n3 2\n");
+    fprintf(fp, "pnnx.Input in0 0 1 0 #0=(1,%i,%i,%i)f32\n", c.in_channels, c.in_h, c.in_w);
+    fprintf(fp,
+            "nn.Conv2d conv 1 1 0 1 bias=True dilation=(%i,%i) groups=%i in_channels=%i "
+            "kernel_size=(%i,%i) out_channels=%i padding=(%i,%i) padding_mode=zeros "
+            "stride=(%i,%i) @weight=(%i,%i,%i,%i)f32 @bias=(%i)f32 #0=(1,%i,%i,%i)f32 "
+            "#1=(1,%i,%i,%i)f32\n",
+            c.dilation_h,
+            c.dilation_w,
+            c.groups,
+            c.in_channels,
+            c.kernel_h,
+            c.kernel_w,
+            c.out_channels,
+            c.pad_h,
+            c.pad_w,
+            c.stride_h,
+            c.stride_w,
+            c.out_channels,
+            c.in_channels / c.groups,
+            c.kernel_h,
+            c.kernel_w,
+            c.out_channels,
+            c.in_channels,
+            c.in_h,
+            c.in_w,
+            c.out_channels,
+            c.OutH(),
+            c.OutW());
+    fprintf(fp, "pnnx.Output out0 1 0 1\n");
+    fclose(fp);
+    return true;
+}
+
+/// @brief y[out_channels, out_h, out_w] of one image, summed in double
+inline std::vector<float> NaiveConv(const ConvCase& c,
+                                    const std::vector<float>& x,
+                                    const std::vector<float>& weight,
+                                    const std::vector<float>& bias) {
+    const int out_h     = c.OutH();
+    const int out_w     = c.OutW();
+    const int group_in  = c.in_channels / c.groups;
+    const int group_out = c.out_channels / c.groups;
+    std::vector<float> y(static_cast<size_t>(c.out_channels) * out_h * out_w);
+    for (int o = 0; o < c.out_channels; ++o) {
+        const int group = o / group_out;
+        for (int oy = 0; oy < out_h; ++oy) {
+            for (int ox = 0; ox < out_w; ++ox) {
+                double sum = bias[o];
+                for (int i = 0; i < group_in; ++i) {
+                    for (int ky = 0; ky < c.kernel_h; ++ky) {
+                        for (int kx = 0; kx < c.kernel_w; ++kx) {
+                            const int iy = oy * c.stride_h - c.pad_h + ky * c.dilation_h;
+                            const int ix = ox * c.stride_w - c.pad_w + kx * c.dilation_w;
+                            if (iy < 0 || iy >= c.in_h || ix < 0 || ix >= c.in_w) {
+                                continue;
+                            }
+                            const int tap = (i * c.kernel_h + ky) * c.kernel_w + kx;
+                            sum += x[((group * group_in + i) * c.in_h + iy) * c.in_w + ix] *
+                                   weight[o * c.FilterSize() + tap];
+                        }
+                    }
+                }
+                y[(o * out_h + oy) * out_w + ox] = static_cast<float>(sum);
+            }
+        }
+    }
+    return y;
+}
+
+/// @brief run the case through a Net built with option on the input x
+inline MStatus RunConvNet(const std::string& path,
+                          const ConvCase& c,
+                          const std::shared_ptr<nn::NetOption>& option,
+                          const std::vector<float>& x,
+                          std::vector<float>& y) {
+    nn::Net net("conv", option);
+    MStatus ret = net.Init(path + ".param", path + ".bin");
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+    const std::vector<uint32_t> shape = {1,
+                                         static_cast<uint32_t>(c.in_channels),
+                                         static_cast<uint32_t>(c.in_h),
+                                         static_cast<uint32_t>(c.in_w)};
+    auto input =
+        std::make_shared<base::Tensor>(shape, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    std::copy(x.begin(), x.end(), input->GetData<float>());
+    std::vector<nn::Net::TensorPtr> output;
+    ret = net.Forward({input}, output);
+    if (ret != MStatus::M_OK) {
+        return ret;
+    }
+    const size_t count = static_cast<size_t>(c.out_channels) * c.OutH() * c.OutW();
+    y.assign(output[0]->GetData<float>(), output[0]->GetData<float>() + count);
+    return MStatus::M_OK;
+}
+} // namespace conv_test
+
+#endif // SIMPLE_NN_TESTS_CONV_UTIL_H_
@@ -0,0 +1,253 @@
+#include "runtime/cpu.h"
+#include "runtime/kernel/gemm.h"
+#include "runtime/net.h"
+#include "runtime/pnnx/store_zip.h"
+#include "utils/aligned_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// the packed gemm against a naive triple loop on every kernel level, levels the host can not
+// run fall back to the best one it can like NetOption::cpu_isa does. the shapes leave a
+// partial panel (N % panel width), a partial micro tile of rows and more than one K block
+namespace {
+using nn::CpuIsa;
+using namespace nn::kernel;
+
+struct GemmCase {
+    int M;
+    int N;
+    int K;
+};
+
+const GemmCase CASES[] = {
+    {1, 1, 1},
+    {1, 1000, 512},
+    {7, 33, 300},
+    {13, 17, 5},
+    {6, 32, 256},
+    {5, 100, 257},
+    {20, 70, 600},
+};
+
+std::vector<float> Random(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> value(-0.5f, 0.5f);
+    std::vector<float> data(count);
+    for (auto& v : data) {
+        v = value(rng);
+    }
+    return data;
+}
+
+float Activate(const Activation& activation, float x) {
+    switch (activation.type) {
+    case ActivationType::M_RELU:
+        return std::max(x, 0.f);
+    case ActivationType::M_LEAKY_RELU:
+        return x > 0.f ? x : activation.alpha * x;
+    case ActivationType::M_SILU:
+        return x / (1.f + std::exp(-x));
+    default:
+        return x;
+    }
+}
+
+// C = A * B + bias, B[k][n] = b[n * K + k] when transposed and b[k * N + n] otherwise
+std::vector<float> NaiveGemm(const GemmCase& s,
+                             const std::vector<float>& a,
+                             const std::vector<float>& b,
+                             bool transposed,
+                             const GemmEpilogue& epilogue) {
+    std::vector<float> c(static_cast<size_t>(s.M) * s.N);
+    for (int i = 0; i < s.M; ++i) {
+        for (int j = 0; j < s.N; ++j) {
+            double sum = 0.0;
+            if (epilogue.bias_mode == BiasMode::M_ROW) {
+                sum = epilogue.bias[i];
+            } else if (epilogue.bias_mode == BiasMode::M_COL) {
+                sum = epilogue.bias[j];
+            }
+            for (int k = 0; k < s.K; ++k) {
+                sum += a[i * s.K + k] * (transposed ? b[j * s.K + k] : b[k * s.N + j]);
+            }
+            c[i * s.N + j] = Activate(epilogue.activation, static_cast<float>(sum));
+        }
+    }
+    return c;
+}
+
+// the epilogue of the mode-th run, none, column bias with leaky relu, row bias with relu
+GemmEpilogue MakeEpilogue(int mode, const std::vector<float>& bias) {
+    GemmEpilogue epilogue;
+    if (mode == 1) {
+        epilogue.bias             = bias.data();
+        epilogue.bias_mode        = BiasMode::M_COL;
+        epilogue.activation.type  = ActivationType::M_LEAKY_RELU;
+        epilogue.activation.alpha = 0.1f;
+    } else if (mode == 2) {
+        epilogue.bias            = bias.data();
+        epilogue.bias_mode       = BiasMode::M_ROW;
+        epilogue.activation.type = ActivationType::M_RELU;
+    }
+    return epilogue;
+}
+
+void ExpectNear(const std::vector<float>& c, const std::vector<float>& ref, const GemmCase& s) {
+    ASSERT_EQ(c.size(), ref.size());
+    for (size_t i = 0; i < c.size(); ++i) {
+        ASSERT_NEAR(c[i], ref[i], 1e-3f) << "M " << s.M << " N " << s.N << " K " << s.K
+                                         << " at " << i;
+    }
+}
+
+class GemmTest : public ::testing::TestWithParam<CpuIsa> {
+protected:
+    void SetUp() override { isa_ = nn::ResolveCpuIsa(GetParam()); }
+
+    CpuIsa isa_{CpuIsa::M_GENERIC};
+    nn::ThreadPool pool_{3, 100};
+};
+
+TEST_P(GemmTest, PackedB) {
+    std::mt19937 rng(1);
+    for (const auto& s : CASES) {
+        const auto a    = Random(static_cast<size_t>(s.M) * s.K, rng);
+        const auto b    = Random(static_cast<size_t>(s.K) * s.N, rng);
+        const auto bias = Random(std::max(s.M, s.N), rng);
+        for (int transposed = 0; transposed < 2; ++transposed) {
+            nn::AlignedBuffer packed(GemmPackedBSize(s.K, s.N, isa_) * sizeof(float));
+            GemmPackB(b.data(),
+                      s.K,
+                      s.N,
+                      transposed ? s.K : s.N,
+                      transposed,
+                      packed.As<float>(),
+                      isa_);
+            for (int mode = 0; mode < 3; ++mode) {
+                const GemmEpilogue epilogue = MakeEpilogue(mode, bias);
+                const auto ref              = NaiveGemm(s, a, b, transposed, epilogue);
+                for (nn::ThreadPool* pool : {static_cast<nn::ThreadPool*>(nullptr), &pool_}) {
+                    std::vector<float> c(ref.size(), 7.f);
+                    SgemmPackedB(s.M,
+                                 s.N,
+                                 s.K,
+                                 a.data(),
+                                 s.K,
+                                 packed.As<float>(),
+                                 c.data(),
+                                 s.N,
+                                 epilogue,
+                                 isa_,
+                                 pool);
+                    ExpectNear(c, ref, s);
+                }
+            }
+        }
+    }
+}
+
+TEST_P(GemmTest, PackOnTheFly) {
+    std::mt19937 rng(2);
+    const int panel = GemmPanelWidth(isa_);
+    for (const auto& s : CASES) {
+        const auto a    = Random(static_cast<size_t>(s.M) * s.K, rng);
+        const auto b    = Random(static_cast<size_t>(s.K) * s.N, rng);
+        const auto bias = Random(std::max(s.M, s.N), rng);
+        // B[k][n] = b[k * N + n] packed block by block, columns past N are zero
+        GemmPackFn pack = [&](int k0, int kc, int n0, float* dst) {
+            for (int k = 0; k < kc; ++k) {
+                for (int j = 0; j < panel; ++j) {
+                    dst[k * panel + j] = n0 + j < s.N ? b[(k0 + k) * s.N + n0 + j] : 0.f;
+                }
+            }
+        };
+        for (int mode = 0; mode < 3; ++mode) {
+            const GemmEpilogue epilogue = MakeEpilogue(mode, bias);
+            const auto ref              = NaiveGemm(s, a, b, false, epilogue);
+            for (nn::ThreadPool* pool : {static_cast<nn::ThreadPool*>(nullptr), &pool_}) {
+                std::vector<float> c(ref.size(), 7.f);
+                SgemmPackOnTheFly(
+                    s.M, s.N, s.K, a.data(), s.K, pack, c.data(), s.N, epilogue, isa_, pool);
+                ExpectNear(c, ref, s);
+            }
+        }
+    }
+}
+
+// nn.Linear with more input features than one K block and an output count no panel width
+// divides, the level picked by NetOption::cpu_isa
+TEST_P(GemmTest, LinearLayer) {
+    const int in_features  = 300;
+    const int out_features = 37;
+    const int batch        = 5;
+    std::mt19937 rng(3);
+    const auto weight = Random(static_cast<size_t>(out_features) * in_features, rng);
+    const auto bias   = Random(out_features, rng);
+
+    const std::string path = ::testing::TempDir() + "gemm_test_linear";
+    pnnx::StoreZipWriter writer;
+    ASSERT_EQ(writer.open(path + ".bin"), 0);
+    writer.write_file("fc.weight", (const char*)weight.data(), weight.size() * sizeof(float));
+    writer.write_file("fc.bias", (const char*)bias.data(), bias.size() * sizeof(float));
+    writer.close();
+    FILE* fp = fopen((path + ".param").c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    fprintf(fp, "7767517\n3 2\n");
+    fprintf(fp, "pnnx.Input in0 0 1 0 #0=(%i,%i)f32\n", batch, in_features);
+    fprintf(fp,
+            "nn.Linear fc 1 1 0 1 bias=True in_features=%i out_features=%i @weight=(%i,%i)f32 "
+            "@bias=(%i)f32 #0=(%i,%i)f32 #1=(%i,%i)f32\n",
+            in_features,
+            out_features,
+            out_features,
+            in_features,
+            out_features,
+            batch,
+            in_features,
+            batch,
+            out_features);
+    fprintf(fp, "pnnx.Output out0 1 0 1\n");
+    fclose(fp);
+
+    auto option         = std::make_shared<nn::NetOption>();
+    option->cpu_isa     = GetParam();
+    option->num_threads = 3;
+    nn::Net net("linear", option);
+    ASSERT_EQ(net.Init(path + ".param", path + ".bin"), MStatus::M_OK);
+
+    auto input = std::make_shared<base::Tensor>(
+        std::vector<uint32_t>{static_cast<uint32_t>(batch), static_cast<uint32_t>(in_features)},
+        M_LAYOUT_NCHW,
+        M_MEM_ON_CPU,
+        M_DATA_TYPE_FLOAT32);
+    const auto x = Random(static_cast<size_t>(batch) * in_features, rng);
+    std::copy(x.begin(), x.end(), input->GetData<float>());
+    std::vector<nn::Net::TensorPtr> output;
+    ASSERT_EQ(net.Forward({input}, output), MStatus::M_OK);
+    ASSERT_EQ(output.size(), 1u);
+
+    GemmEpilogue epilogue;
+    epilogue.bias      = bias.data();
+    epilogue.bias_mode = BiasMode::M_COL;
+    const GemmCase s{batch, out_features, in_features};
+    const auto ref = NaiveGemm(s, x, weight, true, epilogue);
+    ExpectNear(std::vector<float>(output[0]->GetData<float>(),
+                                  output[0]->GetData<float>() + ref.size()),
+               ref,
+               s);
+}
+
+INSTANTIATE_TEST_SUITE_P(CpuIsa,
+                         GemmTest,
+                         ::testing::Values(CpuIsa::M_GENERIC,
+                                           CpuIsa::M_SSE42,
+                                           CpuIsa::M_AVX2,
+                                           CpuIsa::M_AVX512,
+                                           CpuIsa::M_AVX512_VNNI));
+} // namespace
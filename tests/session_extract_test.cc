@@ -0,0 +1,205 @@
+#include "runtime/net.h"
+#include "runtime/pnnx/store_zip.h"
+#include "runtime/session.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Session::Extract memoizes steps while their arena segments still hold their tops and
+// recomputes the ones a later step overwrote. random sequences of SetInput, Forward and
+// Extract over a branching graph must give what a fresh session computes for every blob
+namespace {
+using nn::Net;
+using nn::Session;
+using TensorPtr = Net::TensorPtr;
+
+const int FEATURES = 8;
+const int LAYERS   = 40;
+// the two inputs and one blob per layer
+const int BLOBS = LAYERS + 2;
+
+// two inputs feeding a tree of nn.Linear, every node reads a random earlier blob so the
+// planner has branches to share memory between. blob i is named "i", the leaves are outputs
+void WriteTreeModel(const std::string& param, const std::string& bin, int layers, int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> weight(-0.5f, 0.5f);
+    pnnx::StoreZipWriter writer;
+    ASSERT_EQ(writer.open(bin), 0);
+
+    std::vector<std::string> ops;
+    ops.push_back("pnnx.Input in0 0 1 0 #0=(1,8)f32");
+    ops.push_back("pnnx.Input in1 0 1 1 #1=(1,8)f32");
+    std::vector<int> blobs = {0};
+    std::set<int> consumed;
+    int next = 2;
+    for (int i = 0; i < layers; ++i) {
+        int src = rng() % 2 ? blobs.back() : blobs[rng() % blobs.size()];
+        if (i == layers / 2) {
+            src = 1;
+        }
+        const std::string name = "fc" + std::to_string(i);
+        std::stringstream ss;
+        ss << "nn.Linear " << name << " 1 1 " << src << " " << next
+           << " bias=True in_features=8 out_features=8 @weight=(8,8)f32 @bias=(8)f32 #" << next
+           << "=(1,8)f32";
+        ops.push_back(ss.str());
+
+        std::vector<float> w(FEATURES * FEATURES);
+        for (auto& v : w) {
+            v = weight(rng) * 0.6f;
+        }
+        std::vector<float> b(FEATURES);
+        for (auto& v : b) {
+            v = weight(rng);
+        }
+        writer.write_file(name + ".weight", (const char*)w.data(), w.size() * sizeof(float));
+        writer.write_file(name + ".bias", (const char*)b.data(), b.size() * sizeof(float));
+
+        consumed.insert(src);
+        blobs.push_back(next++);
+    }
+    int outputs = 0;
+    for (size_t i = 1; i < blobs.size(); ++i) {
+        if (!consumed.count(blobs[i])) {
+            ops.push_back("pnnx.Output out" + std::to_string(outputs++) + " 1 0 " +
+                          std::to_string(blobs[i]));
+        }
+    }
+    writer.close();
+
+    FILE* fp = fopen(param.c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    fprintf(fp, "7767517\n%i %i\n", static_cast<int>(ops.size()), next);
+    for (const auto& op : ops) {
+        fprintf(fp, "%s\n", op.c_str());
+    }
+    fclose(fp);
+}
+
+TensorPtr MakeInput(float seed) {
+    auto tensor = std::make_shared<base::Tensor>(
+        std::vector<uint32_t>{1, FEATURES}, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    for (int i = 0; i < FEATURES; ++i) {
+        tensor->GetData<float>()[i] = sinf(seed + i);
+    }
+    return tensor;
+}
+
+std::vector<float> Values(const TensorPtr& tensor) {
+    size_t count = 1;
+    for (auto dim : tensor->GetShape()) {
+        count *= dim;
+    }
+    return std::vector<float>(tensor->GetData<float>(), tensor->GetData<float>() + count);
+}
+
+class SessionExtractTest : public ::testing::TestWithParam<nn::ExecutorMode> {
+protected:
+    void SetUp() override {
+        const std::string path = ::testing::TempDir() + "session_extract_tree";
+        WriteTreeModel(path + ".param", path + ".bin", LAYERS, 7);
+
+        auto option           = std::make_shared<nn::NetOption>();
+        option->executor_mode = GetParam();
+        option->num_threads   = 3;
+        net_                  = std::make_shared<Net>("tree", option);
+        ASSERT_EQ(net_->Init(path + ".param", path + ".bin"), MStatus::M_OK);
+
+        // reference of every blob for both input sets, each from a fresh session
+        for (int set = 0; set < 2; ++set) {
+            inputs_[set][0] = MakeInput(set * 10.f);
+            inputs_[set][1] = MakeInput(set * 10.f + 1.f);
+            for (int blob = 0; blob < BLOBS; ++blob) {
+                Session session(*net_);
+                ASSERT_EQ(session.Init(), MStatus::M_OK);
+                session.SetInput(0, inputs_[set][0]);
+                session.SetInput(1, inputs_[set][1]);
+                TensorPtr tensor;
+                ASSERT_EQ(session.Extract(std::to_string(blob), tensor), MStatus::M_OK);
+                refs_[set].push_back(Values(tensor));
+            }
+        }
+    }
+
+    void ExpectBlob(Session& session, int set, int blob) {
+        TensorPtr tensor;
+        ASSERT_EQ(session.Extract(std::to_string(blob), tensor), MStatus::M_OK);
+        const auto values = Values(tensor);
+        ASSERT_EQ(values.size(), refs_[set][blob].size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            EXPECT_FLOAT_EQ(values[i], refs_[set][blob][i]) << "blob " << blob;
+        }
+    }
+
+    std::shared_ptr<Net> net_;
+    TensorPtr inputs_[2][2];
+    std::vector<std::vector<float>> refs_[2];
+};
+
+TEST_P(SessionExtractTest, ExtractAfterForward) {
+    Session session(*net_);
+    ASSERT_EQ(session.Init(), MStatus::M_OK);
+    std::vector<TensorPtr> outputs;
+    ASSERT_EQ(session.Forward({inputs_[0][0], inputs_[0][1]}, outputs), MStatus::M_OK);
+    for (int blob = 0; blob < BLOBS; ++blob) {
+        ExpectBlob(session, 0, blob);
+    }
+}
+
+TEST_P(SessionExtractTest, RandomSequence) {
+    Session session(*net_);
+    ASSERT_EQ(session.Init(), MStatus::M_OK);
+    int set = 0;
+    session.SetInput(0, inputs_[set][0]);
+    session.SetInput(1, inputs_[set][1]);
+
+    std::mt19937 rng(1);
+    for (int i = 0; i < 2000; ++i) {
+        const int action = rng() % 100;
+        if (action < 3) {
+            set ^= 1;
+            session.SetInput(0, inputs_[set][0]);
+            session.SetInput(1, inputs_[set][1]);
+        } else if (action < 5) {
+            std::vector<TensorPtr> outputs;
+            ASSERT_EQ(session.Forward({inputs_[set][0], inputs_[set][1]}, outputs),
+                      MStatus::M_OK);
+        } else {
+            ExpectBlob(session, set, rng() % BLOBS);
+        }
+        if (HasFatalFailure()) {
+            return;
+        }
+    }
+}
+
+TEST_P(SessionExtractTest, PartialInputs) {
+    // only in0 bound, the blobs below in1 can not be computed and the others must still be
+    Session session(*net_);
+    ASSERT_EQ(session.Init(), MStatus::M_OK);
+    session.SetInput(0, inputs_[0][0]);
+    int extracted = 0;
+    for (int blob = 0; blob < BLOBS; ++blob) {
+        TensorPtr tensor;
+        if (session.Extract(std::to_string(blob), tensor) != MStatus::M_OK) {
+            continue;
+        }
+        ++extracted;
+        EXPECT_EQ(Values(tensor), refs_[0][blob]) << "blob " << blob;
+    }
+    EXPECT_GT(extracted, 0);
+    EXPECT_LT(extracted, BLOBS);
+}
+
+INSTANTIATE_TEST_SUITE_P(Executors,
+                         SessionExtractTest,
+                         ::testing::Values(nn::ExecutorMode::M_SEQUENTIAL,
+                                           nn::ExecutorMode::M_PARALLEL));
+} // namespace
@@ -0,0 +1,156 @@
+#include "conv_util.h"
+#include "runtime/cpu.h"
+#include "runtime/kernel/winograd.h"
+#include "utils/aligned_buffer.h"
+#include "utils/scratch_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+// the winograd F(4x4, 3x3) convolution against a direct convolution on every kernel level,
+// forced through NetOption::cpu_isa and NetOption::conv_algorithm. levels the host can not
+// run fall back to the best one it can. the output sizes leave partial 4x4 tiles and tile
+// counts no panel width divides
+namespace {
+using conv_test::ConvCase;
+using nn::CpuIsa;
+
+// 3x3 stride 1 cases, in_channels, out_channels, groups, in_h, in_w, kernel, stride, pad and
+// dilation per axis
+const ConvCase CASES[] = {
+    // a single partial tile
+    {8, 5, 1, 1, 1, 3, 3, 1, 1, 1, 1, 1, 1},
+    // 4 x 5 tiles, the last row and column partial
+    {3, 8, 1, 13, 17, 3, 3, 1, 1, 1, 1, 1, 1},
+    // pads larger than 1
+    {16, 37, 1, 23, 29, 3, 3, 1, 1, 2, 2, 1, 1},
+    {32, 24, 1, 17, 18, 3, 3, 1, 1, 3, 3, 1, 1},
+    // no pad and a pad on one axis only
+    {70, 20, 1, 9, 11, 3, 3, 1, 1, 0, 0, 1, 1},
+    {12, 9, 1, 10, 7, 3, 3, 1, 1, 0, 2, 1, 1},
+    // more input channels than one gemm K block
+    {300, 16, 1, 6, 6, 3, 3, 1, 1, 1, 1, 1, 1},
+};
+
+// the transforms lose a little more precision than the direct convolution
+const float TOLERANCE = 2e-3f;
+
+struct CaseData {
+    std::vector<float> weight;
+    std::vector<float> bias;
+    std::vector<float> x;
+    std::vector<float> ref;
+};
+
+CaseData MakeCase(const ConvCase& c, std::mt19937& rng) {
+    CaseData data;
+    data.weight = conv_test::Random(static_cast<size_t>(c.out_channels) * c.FilterSize(), rng);
+    data.bias   = conv_test::Random(c.out_channels, rng);
+    data.x      = conv_test::Random(static_cast<size_t>(c.in_channels) * c.in_h * c.in_w, rng);
+    data.ref    = conv_test::NaiveConv(c, data.x, data.weight, data.bias);
+    return data;
+}
+
+void ExpectNear(const std::vector<float>& y, const std::vector<float>& ref, const ConvCase& c) {
+    ASSERT_EQ(y.size(), ref.size());
+    for (size_t i = 0; i < y.size(); ++i) {
+        ASSERT_NEAR(y[i], ref[i], TOLERANCE)
+            << "channels " << c.in_channels << " -> " << c.out_channels << " image " << c.in_h
+            << "x" << c.in_w << " pad " << c.pad_h << "x" << c.pad_w << " at " << i;
+    }
+}
+
+class WinogradTest : public ::testing::TestWithParam<CpuIsa> {};
+
+TEST_P(WinogradTest, Conv2dLayer) {
+    const std::string path = ::testing::TempDir() + "winograd_test";
+    std::mt19937 rng(1);
+    for (const auto& c : CASES) {
+        const CaseData data = MakeCase(c, rng);
+        ASSERT_TRUE(conv_test::WriteConvModel(path, c, data.weight, data.bias));
+        for (int threads : {1, 3}) {
+            auto option            = std::make_shared<nn::NetOption>();
+            option->cpu_isa        = GetParam();
+            option->conv_algorithm = nn::ConvAlgorithm::M_WINOGRAD;
+            option->num_threads    = threads;
+            std::vector<float> y;
+            ASSERT_EQ(conv_test::RunConvNet(path, c, option, data.x, y), MStatus::M_OK);
+            ExpectNear(y, data.ref, c);
+        }
+    }
+}
+
+// the kernel on its own, a pool starting with one slot grows for the other workers and the
+// slots are reused by the next call
+TEST_P(WinogradTest, ScratchSlots) {
+    const CpuIsa isa = nn::ResolveCpuIsa(GetParam());
+    nn::ThreadPool pool(3, 100);
+    std::mt19937 rng(2);
+    for (const auto& c : CASES) {
+        const CaseData data = MakeCase(c, rng);
+        const size_t size   = nn::kernel::Conv3x3WinogradWeightSize(c.in_channels, c.out_channels);
+        nn::AlignedBuffer transformed(size * sizeof(float));
+        nn::kernel::Conv3x3WinogradTransformWeight(
+            data.weight.data(), c.in_channels, c.out_channels, transformed.As<float>());
+        const nn::kernel::ConvShape shape = {c.in_h,
+                                             c.in_w,
+                                             c.OutH(),
+                                             c.OutW(),
+                                             c.kernel_h,
+                                             c.kernel_w,
+                                             c.stride_h,
+                                             c.stride_w,
+                                             c.pad_h,
+                                             c.pad_w,
+                                             c.dilation_h,
+                                             c.dilation_w};
+        const size_t slot_size =
+            nn::kernel::Conv3x3WinogradScratchSize(c.in_channels, c.out_channels, isa);
+
+        nn::ScratchPool scratch;
+        ASSERT_TRUE(scratch.Resize(1, slot_size));
+        for (int run = 0; run < 2; ++run) {
+            std::vector<float> y(data.ref.size(), 7.f);
+            ASSERT_TRUE(nn::kernel::Conv3x3Winograd(shape,
+                                                    c.in_channels,
+                                                    c.out_channels,
+                                                    data.x.data(),
+                                                    transformed.As<float>(),
+                                                    data.bias.data(),
+                                                    nn::kernel::Activation(),
+                                                    y.data(),
+                                                    isa,
+                                                    scratch,
+                                                    &pool));
+            ExpectNear(y, data.ref, c);
+        }
+
+        // slots smaller than the kernel needs are refused instead of overrun
+        ASSERT_TRUE(scratch.Resize(1, slot_size - 1));
+        std::vector<float> y(data.ref.size());
+        EXPECT_FALSE(nn::kernel::Conv3x3Winograd(shape,
+                                                 c.in_channels,
+                                                 c.out_channels,
+                                                 data.x.data(),
+                                                 transformed.As<float>(),
+                                                 data.bias.data(),
+                                                 nn::kernel::Activation(),
+                                                 y.data(),
+                                                 isa,
+                                                 scratch,
+                                                 nullptr));
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(CpuIsa,
+                         WinogradTest,
+                         ::testing::Values(CpuIsa::M_GENERIC,
+                                           CpuIsa::M_SSE42,
+                                           CpuIsa::M_AVX2,
+                                           CpuIsa::M_AVX512,
+                                           CpuIsa::M_AVX512_VNNI));
+} // namespace